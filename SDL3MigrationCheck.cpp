@@ -3,1831 +3,2730 @@
 #include <clang-tidy/ClangTidyModuleRegistry.h>
 #include <clang/AST/ASTContext.h>
 #include <clang/AST/OperationKinds.h>
+#include <clang/AST/RecursiveASTVisitor.h>
 #include <clang/ASTMatchers/ASTMatchFinder.h>
 #include <clang/ASTMatchers/ASTMatchers.h>
 #include <clang/Basic/SourceManager.h>
 #include <clang/Lex/Lexer.h>
 #include <clang/Lex/PPCallbacks.h>
 #include <clang/Lex/Preprocessor.h>
+#include <llvm/ADT/DenseMap.h>
+#include <llvm/ADT/DenseSet.h>
+#include <llvm/ADT/STLExtras.h>
+#include <llvm/ADT/SmallPtrSet.h>
+#include <llvm/ADT/SmallString.h>
+#include <llvm/ADT/SmallVector.h>
+#include <llvm/ADT/StringExtras.h>
+#include <llvm/ADT/StringMap.h>
+#include <llvm/ADT/Twine.h>
+#include <llvm/Support/Endian.h>
+#include <llvm/Support/FileSystem.h>
+#include <llvm/Support/Format.h>
+#include <llvm/Support/JSON.h>
+#include <llvm/Support/MemoryBuffer.h>
+#include <llvm/Support/Path.h>
+#include <llvm/Support/TimeProfiler.h>
+#include <llvm/Support/xxhash.h>
+#include <chrono>
+#include <deque>
+#include <map>
 #include <memory>
+#include <mutex>
+#include <tuple>
+#include <optional>
+#include <vector>
 
 using namespace clang;
 using namespace clang::tidy;
 using namespace clang::ast_matchers;
 
-// Helper: match a plain C function call by name
-static auto FnCallMatcher(StringRef FunctionName, StringRef BindName) {
-  return callExpr(callee(implicitCastExpr(
-                      hasCastKind(CK_FunctionToPointerDecay),
-                      hasSourceExpression(declRefExpr(
-                          to(functionDecl(hasName(FunctionName))))))))
-      .bind(BindName);
-}
-
 // ---------------------------------------------------------------------------
-// PPCallback: rewrites SDL2 #include directives to SDL3 paths
+// Migration registry: one constexpr perfect-hash table of every SDL2 name,
+// generated at build time from SDL3Migrations.txt by
+// tools/gen_migration_tables.py and shared by all checks. Each name is owned
+// by exactly one check, so enabling several checks never reports it twice.
+// A second table, SDLBoolReturns, lists the functions whose int error code
+// became bool.
 // ---------------------------------------------------------------------------
-class SDLIncludeCallback : public PPCallbacks {
-public:
-  SDLIncludeCallback(ClangTidyCheck &Check, const SourceManager &SM)
-      : Check(Check), SM(SM) {};
-  void InclusionDirective(SourceLocation HashLoc, const Token &IncludeTok,
-                          StringRef FileName, bool isAngled,
-                          CharSourceRange FilenameRange,
-                          OptionalFileEntryRef file, StringRef SearchPath,
-                          StringRef RelativePath, const Module *imported,
-                          bool ModuleImported,
-                          SrcMgr::CharacteristicKind FileType) override {
-    if (!SM.isInMainFile(HashLoc)) {
-      return;
-    }
-    if (FileName.contains("SDL") ||
-        FileName.contains("SDL2") && !FileName.contains("SDL3")) {
-      llvm::outs() << "Found an SDL or SDL2 file\n";
-      llvm::outs() << "File Entry actually exists\n";
-      llvm::outs() << "FileName is:  " << FileName << "\n";
-      std::string Replacement;
-      if (FileName == "SDL2/SDL.h") {
-        Replacement = "SDL3/SDL.h";
-      } else if (FileName == "SDL2/SDL_gamecontroller.h") {
-        Replacement = "SDL3/SDL_gamepad.h";
-      } else if (FileName.starts_with("SDL2/")) {
-        Replacement = "SDL3/" + FileName.substr(5).str();
-      } else if (FileName == "SDL.h") {
-        Replacement = "SDL3/SDL.h";
-      } else if (FileName.starts_with("SDL_")) {
-        Replacement = "SDL3/" + FileName.str();
-      }
+enum class MigrationCheck {
+  Atomic,
+  Audio,
+  Init,
+  Gamepad,
+  Joystick,
+  Haptic,
+  Mouse,
+  Render,
+  Mutex,
+  Rect,
+  Surface,
+  IOStream,
+  Log,
+  Pixels,
+};
 
-      if (!Replacement.empty()) {
-        llvm::outs() << "Replacement is not empty\n";
-        std::string FormattedReplacement =
-            isAngled ? ("<" + Replacement + ">") : ("\"" + Replacement + "\"");
-
-        Check.diag(HashLoc, "replace with %0")
-            << Replacement
-            << FixItHint::CreateReplacement(FilenameRange,
-                                            FormattedReplacement);
-      }
-    }
+enum class MigrationKind {
+  FunctionRename,
+  RemovedFunction,
+  SymbolRename,
+  TypeRename,
+  BoolReturn, // int error code became bool; SDLBoolReturns only
+};
+
+struct MigrationEntry {
+  MigrationCheck Check; // the check that reports OldName
+  MigrationKind Kind;
+  StringRef Header;  // SDL2 header declaring OldName
+  StringRef OldName;
+  StringRef NewName; // empty for removed functions
+  StringRef Note;    // optional, appended to the diagnostic
+};
+
+// Bit of a MigrationCheck or MigrationKind in a mask of them
+template <typename Enum> static constexpr uint32_t MaskOf(Enum Value) {
+  return 1u << static_cast<unsigned>(Value);
+}
+
+static uint32_t SubsystemsMask(std::initializer_list<MigrationCheck> Checks) {
+  uint32_t Mask = 0;
+  for (MigrationCheck Check : Checks)
+    Mask |= MaskOf(Check);
+  return Mask;
+}
+
+// 32-bit FNV-1a of Name, mixed with the seed by the murmur3 finalizer so that
+// every bit of the result depends on every bit of the seed (FNV alone keeps
+// the low bits of its offset basis); must match migration_hash() in
+// tools/gen_migration_tables.py
+static uint32_t MigrationHash(uint32_t Seed, StringRef Name) {
+  uint32_t Hash = 2166136261u;
+  for (char C : Name)
+    Hash = (Hash ^ static_cast<unsigned char>(C)) * 16777619u;
+  Hash ^= Seed * 0x9e3779b9u;
+  Hash = (Hash ^ (Hash >> 16)) * 0x85ebca6bu;
+  Hash = (Hash ^ (Hash >> 13)) * 0xc2b2ae35u;
+  return Hash ^ (Hash >> 16);
+}
+
+// Slot of Name in a minimal perfect hash with these seeds, one per slot. A
+// negative seed S stands for slot -S - 1, i.e. ~S; seeds not built for
+// Seeds.size() names (a corrupt database) can give a slot past the end
+template <typename Seed>
+static size_t PerfectHashSlot(ArrayRef<Seed> Seeds, StringRef Name) {
+  int32_t S = Seeds[MigrationHash(0, Name) % Seeds.size()];
+  if (S < 0)
+    return static_cast<size_t>(~S);
+  return MigrationHash(S, Name) % Seeds.size();
+}
+
+// Minimal perfect hash (hash-and-displace) over the SDL2 names of Entry's
+// OldName field. The first hash picks a seed; a negative seed is the slot
+// itself, otherwise the seeded hash gives the slot. Every slot is occupied, so
+// a lookup is two hashes and one string compare.
+template <typename Entry> class PerfectHashTable {
+public:
+  constexpr PerfectHashTable(ArrayRef<Entry> Slots, ArrayRef<int32_t> Seeds)
+      : Slots(Slots), Seeds(Seeds) {}
+
+  const Entry *lookup(StringRef Name) const {
+    if (Slots.empty())
+      return nullptr;
+    size_t Slot = PerfectHashSlot(Seeds, Name);
+    return Slots[Slot].OldName == Name ? &Slots[Slot] : nullptr;
   }
 
-private:
-  ClangTidyCheck &Check;
-  const SourceManager &SM;
+protected:
+  ArrayRef<Entry> Slots;
+  ArrayRef<int32_t> Seeds;
 };
 
-// ---------------------------------------------------------------------------
-// Rename/removal tables shared across checks (SDL_init.h scope)
-// ---------------------------------------------------------------------------
-static const char *FunctionRenames[][3] = {
-    // SDL_endian.h
-    {"SDL_SwapBE16", "SDL_Swap16BE", ""},
-    {"SDL_SwapBE32", "SDL_Swap32BE", ""},
-    {"SDL_SwapBE64", "SDL_Swap64BE", ""},
-    {"SDL_SwapLE16", "SDL_Swap16LE", ""},
-    {"SDL_SwapLE32", "SDL_Swap32LE", ""},
-    {"SDL_SwapLE64", "SDL_Swap64LE", ""},
-    // SDL_cpuinfo.h
-    {"SDL_GetCPUCount", "SDL_GetNumLogicalCPUCores", ""},
-    {"SDL_SIMDGetAlignment", "SDL_GetSIMDAlignment", ""},
+class MigrationRegistry : public PerfectHashTable<MigrationEntry> {
+public:
+  using PerfectHashTable::PerfectHashTable;
+
+  // Whether a check in CheckMask owns a row of a kind in KindMask
+  bool hasRows(uint32_t CheckMask, uint32_t KindMask) const {
+    return llvm::any_of(Slots, [&](const MigrationEntry &Entry) {
+      return (MaskOf(Entry.Check) & CheckMask) &&
+             (MaskOf(Entry.Kind) & KindMask);
+    });
+  }
 };
 
-static const char *RemovedFunctions[][2] = {
-    {"SDL_GetNumAudioDevices", ""},
-    {"SDL_GetAudioDeviceSpec", ""},
-    {"SDL_ConvertAudio", ""},
-    {"SDL_BuildAudioCVT", ""},
-    {"SDL_OpenAudio", ""},
-    {"SDL_CloseAudio", ""},
-    {"SDL_PauseAudio", ""},
-    {"SDL_GetAudioStatus", ""},
-    {"SDL_GetAudioDeviceStatus", ""},
-    {"SDL_GetDefaultAudioInfo", ""},
-    {"SDL_LockAudio", ""},
-    {"SDL_LockAudioDevice", ""},
-    {"SDL_UnlockAudio", ""},
-    {"SDL_UnlockAudioDevice", ""},
-    {"SDL_QueueAudio", ""},
-    {"SDL_DequeueAudio", ""},
-    {"SDL_ClearAudioQueue", ""},
-    {"SDL_GetQueuedAudioSize", ""},
+// Call rewrites: SDL2 calls whose arguments change in SDL3, written in
+// SDL3Migrations.txt as templates such as
+//   rewrite SDL_PauseAudioDevice($0,0) SDL_ResumeAudioDevice($0) MESSAGE
+// and compiled by the generator into flat tables, so applying one splices the
+// source of the call's arguments between constant pieces of text.
+struct RewriteArg {
+  bool Any;         // $N: any expression
+  uint64_t Literal; // otherwise the integer literal the argument must be
 };
 
-static const char *SymbolMigrations[][3] = {
-    // SDL_audio.h format symbols
-    {"AUDIO_F32", "SDL_AUDIO_F32LE", ""},
-    {"AUDIO_F32LSB", "SDL_AUDIO_F32LE", ""},
-    {"AUDIO_F32MSB", "SDL_AUDIO_F32BE", ""},
-    {"AUDIO_F32SYS", "SDL_AUDIO_F32", ""},
-    {"AUDIO_S16", "SDL_AUDIO_S16LE", ""},
-    {"AUDIO_S16LSB", "SDL_AUDIO_S16LE", ""},
-    {"AUDIO_S16MSB", "SDL_AUDIO_S16BE", ""},
-    {"AUDIO_S16SYS", "SDL_AUDIO_S16", ""},
-    {"AUDIO_S32", "SDL_AUDIO_S32LE", ""},
-    {"AUDIO_S32LSB", "SDL_AUDIO_S32LE", ""},
-    {"AUDIO_S32MSB", "SDL_AUDIO_S32BE", ""},
-    {"AUDIO_S32SYS", "SDL_AUDIO_S32", ""},
-    {"AUDIO_S8", "SDL_AUDIO_S8", ""},
-    {"AUDIO_U8", "SDL_AUDIO_U8", ""},
-
-    // SDL_events.h symbols
-    {"SDL_APP_DIDENTERBACKGROUND", "SDL_EVENT_DID_ENTER_BACKGROUND", ""},
-    {"SDL_APP_DIDENTERFOREGROUND", "SDL_EVENT_DID_ENTER_FOREGROUND", ""},
-    {"SDL_APP_LOWMEMORY", "SDL_EVENT_LOW_MEMORY", ""},
-    {"SDL_APP_TERMINATING", "SDL_EVENT_TERMINATING", ""},
-    {"SDL_APP_WILLENTERBACKGROUND", "SDL_EVENT_WILL_ENTER_BACKGROUND", ""},
-    {"SDL_APP_WILLENTERFOREGROUND", "SDL_EVENT_WILL_ENTER_FOREGROUND", ""},
-    {"SDL_AUDIODEVICEADDED", "SDL_EVENT_AUDIO_DEVICE_ADDED", ""},
-    {"SDL_AUDIODEVICEREMOVED", "SDL_EVENT_AUDIO_DEVICE_REMOVED", ""},
-    {"SDL_CLIPBOARDUPDATE", "SDL_EVENT_CLIPBOARD_UPDATE", ""},
-    {"SDL_CONTROLLERAXISMOTION", "SDL_EVENT_GAMEPAD_AXIS_MOTION", ""},
-    {"SDL_CONTROLLERBUTTONDOWN", "SDL_EVENT_GAMEPAD_BUTTON_DOWN", ""},
-    {"SDL_CONTROLLERBUTTONUP", "SDL_EVENT_GAMEPAD_BUTTON_UP", ""},
-    {"SDL_CONTROLLERDEVICEADDED", "SDL_EVENT_GAMEPAD_ADDED", ""},
-    {"SDL_CONTROLLERDEVICEREMAPPED", "SDL_EVENT_GAMEPAD_REMAPPED", ""},
-    {"SDL_CONTROLLERDEVICEREMOVED", "SDL_EVENT_GAMEPAD_REMOVED", ""},
-    {"SDL_CONTROLLERSENSORUPDATE", "SDL_EVENT_GAMEPAD_SENSOR_UPDATE", ""},
-    {"SDL_CONTROLLERSTEAMHANDLEUPDATED",
-     "SDL_EVENT_GAMEPAD_STEAM_HANDLE_UPDATED", ""},
-    {"SDL_CONTROLLERTOUCHPADDOWN", "SDL_EVENT_GAMEPAD_TOUCHPAD_DOWN", ""},
-    {"SDL_CONTROLLERTOUCHPADMOTION", "SDL_EVENT_GAMEPAD_TOUCHPAD_MOTION", ""},
-    {"SDL_CONTROLLERTOUCHPADUP", "SDL_EVENT_GAMEPAD_TOUCHPAD_UP", ""},
-    {"SDL_DROPBEGIN", "SDL_EVENT_DROP_BEGIN", ""},
-    {"SDL_DROPCOMPLETE", "SDL_EVENT_DROP_COMPLETE", ""},
-    {"SDL_DROPFILE", "SDL_EVENT_DROP_FILE", ""},
-    {"SDL_DROPTEXT", "SDL_EVENT_DROP_TEXT", ""},
-    {"SDL_FINGERDOWN", "SDL_EVENT_FINGER_DOWN", ""},
-    {"SDL_FINGERMOTION", "SDL_EVENT_FINGER_MOTION", ""},
-    {"SDL_FINGERUP", "SDL_EVENT_FINGER_UP", ""},
-    {"SDL_FIRSTEVENT", "SDL_EVENT_FIRST", ""},
-    {"SDL_JOYAXISMOTION", "SDL_EVENT_JOYSTICK_AXIS_MOTION", ""},
-    {"SDL_JOYBALLMOTION", "SDL_EVENT_JOYSTICK_BALL_MOTION", ""},
-    {"SDL_JOYBATTERYUPDATED", "SDL_EVENT_JOYSTICK_BATTERY_UPDATED", ""},
-    {"SDL_JOYBUTTONDOWN", "SDL_EVENT_JOYSTICK_BUTTON_DOWN", ""},
-    {"SDL_JOYBUTTONUP", "SDL_EVENT_JOYSTICK_BUTTON_UP", ""},
-    {"SDL_JOYDEVICEADDED", "SDL_EVENT_JOYSTICK_ADDED", ""},
-    {"SDL_JOYDEVICEREMOVED", "SDL_EVENT_JOYSTICK_REMOVED", ""},
-    {"SDL_JOYHATMOTION", "SDL_EVENT_JOYSTICK_HAT_MOTION", ""},
-    {"SDL_KEYDOWN", "SDL_EVENT_KEY_DOWN", ""},
-    {"SDL_KEYMAPCHANGED", "SDL_EVENT_KEYMAP_CHANGED", ""},
-    {"SDL_KEYUP", "SDL_EVENT_KEY_UP", ""},
-    {"SDL_LASTEVENT", "SDL_EVENT_LAST", ""},
-    {"SDL_LOCALECHANGED", "SDL_EVENT_LOCALE_CHANGED", ""},
-    {"SDL_MOUSEBUTTONDOWN", "SDL_EVENT_MOUSE_BUTTON_DOWN", ""},
-    {"SDL_MOUSEBUTTONUP", "SDL_EVENT_MOUSE_BUTTON_UP", ""},
-    {"SDL_MOUSEMOTION", "SDL_EVENT_MOUSE_MOTION", ""},
-    {"SDL_MOUSEWHEEL", "SDL_EVENT_MOUSE_WHEEL", ""},
-    {"SDL_POLLSENTINEL", "SDL_EVENT_POLL_SENTINEL", ""},
-    {"SDL_QUIT", "SDL_EVENT_QUIT", ""},
-    {"SDL_RENDER_DEVICE_RESET", "SDL_EVENT_RENDER_DEVICE_RESET", ""},
-    {"SDL_RENDER_TARGETS_RESET", "SDL_EVENT_RENDER_TARGETS_RESET", ""},
-    {"SDL_SENSORUPDATE", "SDL_EVENT_SENSOR_UPDATE", ""},
-    {"SDL_TEXTEDITING", "SDL_EVENT_TEXT_EDITING", ""},
-    {"SDL_TEXTEDITING_EXT", "SDL_EVENT_TEXT_EDITING_EXT", ""},
-    {"SDL_TEXTINPUT", "SDL_EVENT_TEXT_INPUT", ""},
-    {"SDL_USEREVENT", "SDL_EVENT_USER", ""},
+struct RewritePiece {
+  StringLiteral Text;
+  int8_t Arg; // argument whose source follows Text, -1 for none
 };
 
-// ---------------------------------------------------------------------------
-// Helper to emit a function-rename diagnostic with a FixIt
-// ---------------------------------------------------------------------------
-template <typename NodeT>
-static void EmitFuncRenameFixit(ClangTidyCheck &Check, const NodeT *Call,
-                                const char *OldName, const char *NewName) {
-  Check.diag(Call->getBeginLoc(), "%0() has been renamed to %1() in SDL3")
-      << OldName << NewName
-      << FixItHint::CreateReplacement(Call->getCallee()->getSourceRange(),
-                                      NewName);
-}
+struct CallRewrite {
+  uint16_t FirstArg, NumArgs;     // slice of SDLRewriteArgs
+  uint16_t FirstPiece, NumPieces; // slice of SDLRewritePieces
+  StringLiteral Message;
+};
 
-// ---------------------------------------------------------------------------
-// SDL3AtomicCheck  (SDL_atomic.h)
-// ---------------------------------------------------------------------------
-static const char *AtomicFuncRenames[][2] = {
-    {"SDL_AtomicAdd", "SDL_AddAtomicInt"},
-    {"SDL_AtomicCAS", "SDL_CompareAndSwapAtomicInt"},
-    {"SDL_AtomicCASPtr", "SDL_CompareAndSwapAtomicPointer"},
-    {"SDL_AtomicGet", "SDL_GetAtomicInt"},
-    {"SDL_AtomicGetPtr", "SDL_GetAtomicPointer"},
-    {"SDL_AtomicLock", "SDL_LockSpinlock"},
-    {"SDL_AtomicSet", "SDL_SetAtomicInt"},
-    {"SDL_AtomicSetPtr", "SDL_SetAtomicPointer"},
-    {"SDL_AtomicTryLock", "SDL_TryLockSpinlock"},
-    {"SDL_AtomicUnlock", "SDL_UnlockSpinlock"},
+// All templates of one SDL2 function, in data file order
+struct CallRewriteSet {
+  MigrationCheck Check; // the check that reports OldName
+  StringLiteral Header; // SDL2 header declaring OldName
+  StringLiteral OldName;
+  uint16_t First, Count; // slice of SDLCallRewriteList
 };
 
-class SDL3AtomicCheck : public ClangTidyCheck {
+class CallRewriteTable : public PerfectHashTable<CallRewriteSet> {
 public:
-  SDL3AtomicCheck(StringRef Name, ClangTidyContext *Context)
-      : ClangTidyCheck(Name, Context) {}
+  using PerfectHashTable::PerfectHashTable;
 
-  void registerPPCallbacks(const SourceManager &SM, Preprocessor *PP,
-                           Preprocessor *ModuleExpanderPP) override {
-    PP->addPPCallbacks(::std::make_unique<SDLIncludeCallback>(*this, SM));
+  // Whether a check in CheckMask owns a template
+  bool hasRows(uint32_t CheckMask) const {
+    return llvm::any_of(Slots, [&](const CallRewriteSet &Set) {
+      return MaskOf(Set.Check) & CheckMask;
+    });
   }
+};
 
-  void registerMatchers(ast_matchers::MatchFinder *Finder) override {
-    for (const auto &R : AtomicFuncRenames) {
-      Finder->addMatcher(
-          callExpr(callee(functionDecl(hasName(R[0])))).bind(R[0]), this);
-    }
+// The checks owning rows declared in one SDL2 header
+struct HeaderChecks {
+  StringLiteral Header;
+  uint32_t CheckMask;
+};
 
-    Finder->addMatcher(
-        varDecl(hasType(asString("SDL_atomic_t"))).bind("sdl_atomic_t_var"),
-        this);
+// Minimal perfect hash over the SDL2 headers of the data file, as
+// PerfectHashTable but keyed by the header name
+class HeaderChecksTable {
+public:
+  constexpr HeaderChecksTable(ArrayRef<HeaderChecks> Slots,
+                              ArrayRef<int32_t> Seeds)
+      : Slots(Slots), Seeds(Seeds) {}
+
+  // Mask of the checks owning names declared in the SDL2 header Header
+  uint32_t checksOf(StringRef Header) const {
+    if (Slots.empty())
+      return 0;
+    const HeaderChecks &Slot = Slots[PerfectHashSlot(Seeds, Header)];
+    return Slot.Header == Header ? Slot.CheckMask : 0;
   }
 
-  void check(const ast_matchers::MatchFinder::MatchResult &Result) override {
-    for (const auto &R : AtomicFuncRenames) {
-      if (const auto *Call = Result.Nodes.getNodeAs<CallExpr>(R[0])) {
-        diag(Call->getBeginLoc(), "%0() has been renamed to %1() in SDL3")
-            << R[0] << R[1]
-            << FixItHint::CreateReplacement(Call->getCallee()->getSourceRange(),
-                                            R[1]);
-        return;
-      }
-    }
-
-    if (const auto *Var = Result.Nodes.getNodeAs<VarDecl>("sdl_atomic_t_var")) {
-      diag(Var->getLocation(),
-           "SDL_atomic_t has been renamed to SDL_AtomicInt in SDL3")
-          << FixItHint::CreateReplacement(
-                 Var->getTypeSourceInfo()->getTypeLoc().getSourceRange(),
-                 "SDL_AtomicInt");
-    }
-  }
+private:
+  ArrayRef<HeaderChecks> Slots;
+  ArrayRef<int32_t> Seeds;
 };
 
+#include "SDL3MigrationTables.inc"
+
+// Helper: name of the function called by Call
+static StringRef CalleeName(const CallExpr *Call) {
+  if (const auto *FD = Call->getDirectCallee())
+    if (FD->getIdentifier())
+      return FD->getName();
+  return {};
+}
+
+// Helper: source text of a matched expression, pointing into the file buffer
+static StringRef SourceText(const Expr *E,
+                            const ast_matchers::MatchFinder::MatchResult &R) {
+  return Lexer::getSourceText(
+      CharSourceRange::getTokenRange(E->getSourceRange()), *R.SourceManager,
+      R.Context->getLangOpts());
+}
+
+// Helper: whether the directory Dir holds the headers of SDL2, i.e. an
+// SDL_version.h defining SDL_MAJOR_VERSION as 2. Read once per directory and
+// process
+static bool HasSDL2Version(StringRef Dir) {
+  static std::mutex Lock;
+  static llvm::StringMap<bool> Dirs;
+  std::lock_guard<std::mutex> Guard(Lock);
+  auto [It, Inserted] = Dirs.try_emplace(Dir, false);
+  if (!Inserted)
+    return It->second;
+  SmallString<256> Path(Dir);
+  llvm::sys::path::append(Path, "SDL_version.h");
+  llvm::ErrorOr<std::unique_ptr<llvm::MemoryBuffer>> Buffer =
+      llvm::MemoryBuffer::getFile(Path);
+  if (!Buffer)
+    return false;
+  StringRef Text = (*Buffer)->getBuffer();
+  StringRef Define = "#define SDL_MAJOR_VERSION";
+  size_t Pos = Text.find(Define);
+  if (Pos == StringRef::npos)
+    return false;
+  StringRef Value = Text.substr(Pos + Define.size()).ltrim(" \t");
+  unsigned Major = 0;
+  It->second = !Value.consumeInteger(10, Major) && Major == 2;
+  return It->second;
+}
+
+// Helper: whether File is an SDL2 header: it lives in a directory named
+// SDL2, which is how SDL2 installs lay out their headers (<SDL2/SDL.h>,
+// -I.../SDL2), or, for SDL2 vendored into a directory of another name
+// (third_party/sdl/include/SDL.h), next to SDL2's SDL_version.h. SDL3's own
+// headers share most of their names with SDL2's, so a directory named SDL3
+// never counts
+static bool IsSDL2Header(FileEntryRef File) {
+  StringRef Dir = llvm::sys::path::parent_path(File.getName());
+  StringRef DirName = llvm::sys::path::filename(Dir);
+  if (DirName == "SDL2")
+    return true;
+  if (DirName == "SDL3")
+    return false;
+  StringRef RealPath = File.getFileEntry().tryGetRealPathName();
+  return HasSDL2Version(RealPath.empty()
+                            ? Dir
+                            : llvm::sys::path::parent_path(RealPath));
+}
+
 // ---------------------------------------------------------------------------
-// SDL3AudioCheck  (SDL_audio.h)
+// MigrationDatabase: rename rows compiled by tools/compile_migration_db.py
+// into a binary file (option MigrationDatabase), for renames SDL3Migrations.txt
+// does not have yet and for the wrappers of a project's own, without
+// rebuilding the plugin. The file is mapped read-only, once per process, so
+// parallel clang-tidy processes share its pages, and loading it only checks
+// its header: startup does not grow with the number of rows. Layout, all
+// integers little endian (see the tool):
+//   DBHeader
+//   DBEntry[NumEntries]      perfect-hash slots, as in PerfectHashTable
+//   int32 Seeds[NumEntries]
+//   DBHeaderRow[NumHeaders]  sorted by name
+//   char Strings[StringsSize]
 // ---------------------------------------------------------------------------
-static const char *AudioFuncRenames[][2] = {
-    {"SDL_AudioStreamAvailable", "SDL_GetAudioStreamAvailable"},
-    {"SDL_AudioStreamClear", "SDL_ClearAudioStream"},
-    {"SDL_AudioStreamFlush", "SDL_FlushAudioStream"},
-    {"SDL_AudioStreamGet", "SDL_GetAudioStreamData"},
-    {"SDL_AudioStreamPut", "SDL_PutAudioStreamData"},
-    {"SDL_FreeAudioStream", "SDL_DestroyAudioStream"},
-    {"SDL_LoadWAV_RW", "SDL_LoadWAV_IO"},
-};
-
-static const char *AudioFormatMigrations[][3] = {
-    {"AUDIO_F32", "SDL_AUDIO_F32LE", ""},
-    {"AUDIO_F32LSB", "SDL_AUDIO_F32LE", ""},
-    {"AUDIO_F32MSB", "SDL_AUDIO_F32BE", ""},
-    {"AUDIO_F32SYS", "SDL_AUDIO_F32", ""},
-    {"AUDIO_S16", "SDL_AUDIO_S16LE", ""},
-    {"AUDIO_S16LSB", "SDL_AUDIO_S16LE", ""},
-    {"AUDIO_S16MSB", "SDL_AUDIO_S16BE", ""},
-    {"AUDIO_S16SYS", "SDL_AUDIO_S16", ""},
-    {"AUDIO_S32", "SDL_AUDIO_S32LE", ""},
-    {"AUDIO_S32LSB", "SDL_AUDIO_S32LE", ""},
-    {"AUDIO_S32MSB", "SDL_AUDIO_S32BE", ""},
-    {"AUDIO_S32SYS", "SDL_AUDIO_S32", ""},
-    {"AUDIO_S8", "SDL_AUDIO_S8", ""},
-    {"AUDIO_U8", "SDL_AUDIO_U8", ""}};
-
-class SDL3AudioCheck : public ClangTidyCheck {
+class MigrationDatabase {
 public:
-  SDL3AudioCheck(StringRef Name, ClangTidyContext *Context)
-      : ClangTidyCheck(Name, Context) {}
-
-  void registerPPCallbacks(const SourceManager &SM, Preprocessor *PP,
-                           Preprocessor *ModuleExpanderPP) override {
-    PP->addPPCallbacks(::std::make_unique<SDLIncludeCallback>(*this, SM));
+  // The database at Path, mapped by the first call; null, with Error set, if
+  // it cannot be used
+  static const MigrationDatabase *get(StringRef Path, std::string &Error) {
+    static std::mutex Lock;
+    static llvm::StringMap<std::pair<std::unique_ptr<MigrationDatabase>,
+                                     std::string>>
+        Loaded;
+    std::lock_guard<std::mutex> Guard(Lock);
+    auto [It, Inserted] = Loaded.try_emplace(Path);
+    auto &[Database, LoadError] = It->second;
+    if (Inserted)
+      Database = load(Path, LoadError);
+    Error = LoadError;
+    return Database.get();
   }
 
-  void registerMatchers(ast_matchers::MatchFinder *Finder) override {
-    Finder->addMatcher(FnCallMatcher("SDL_AudioInit", "sdl_audio_init"), this);
-    Finder->addMatcher(FnCallMatcher("SDL_AudioQuit", "sdl_audio_quit"), this);
-    Finder->addMatcher(FnCallMatcher("SDL_FreeWAV", "sdl_free_wav"), this);
-    Finder->addMatcher(
-        callExpr(callee(implicitCastExpr(
-                     hasCastKind(CK_FunctionToPointerDecay),
-                     hasSourceExpression(declRefExpr(
-                         to(functionDecl(hasName("SDL_MixAudioFormat"))))))),
-                 hasArgument(2, expr().bind("audio_format_arg")),
-                 hasArgument(4, expr().bind("audio_volume")))
-            .bind("sdl_mix_audio_format"),
-        this);
-    Finder->addMatcher(
-        callExpr(callee(implicitCastExpr(
-                     hasCastKind(CK_FunctionToPointerDecay),
-                     hasSourceExpression(declRefExpr(to(
-                         functionDecl(hasName("SDL_GetNumAudioDevices"))))))),
-                 hasArgument(0, integerLiteral().bind("device_type")))
-            .bind("get_num_audio_devices"),
-        this);
-
-    Finder->addMatcher(
-        callExpr(callee(implicitCastExpr(
-                     hasCastKind(CK_FunctionToPointerDecay),
-                     hasSourceExpression(declRefExpr(
-                         to(functionDecl(hasName("SDL_PauseAudioDevice"))))))),
-                 hasArgument(0, expr().bind("device_arg")),
-                 hasArgument(1, integerLiteral().bind("pause_value")))
-            .bind("sdl_pause_audio_device"),
-        this);
-
-    Finder->addMatcher(
-        callExpr(callee(implicitCastExpr(
-                     hasCastKind(CK_FunctionToPointerDecay),
-                     hasSourceExpression(declRefExpr(to(
-                         functionDecl(hasName("SDL_GetAudioDeviceStatus"))))))),
-                 hasArgument(0, expr().bind("device_arg")))
-            .bind("sdl_get_audio_device_status"),
-        this);
-
-    Finder->addMatcher(
-        callExpr(callee(implicitCastExpr(
-                     hasCastKind(CK_FunctionToPointerDecay),
-                     hasSourceExpression(declRefExpr(
-                         to(functionDecl(hasName("SDL_NewAudioStream"))))))),
-                 hasArgument(0, expr().bind("src_format")),
-                 hasArgument(1, expr().bind("src_channels")),
-                 hasArgument(2, expr().bind("src_rate")),
-                 hasArgument(3, expr().bind("dst_format")),
-                 hasArgument(4, expr().bind("dst_channels")),
-                 hasArgument(5, expr().bind("dst_rate")))
-            .bind("sdl_new_audio_stream"),
-        this);
-
-    for (const auto &S : AudioFormatMigrations) {
-      Finder->addMatcher(declRefExpr(to(namedDecl(hasName(S[0])))).bind(S[0]),
-                         this);
-    }
+  // Row of Name; the database stores no MigrationEntry, so it is built here
+  std::optional<MigrationEntry> lookup(StringRef Name) const {
+    if (Entries.empty())
+      return std::nullopt;
+    size_t Slot = PerfectHashSlot(Seeds, Name);
+    if (Slot >= Entries.size())
+      return std::nullopt;
+    const DBEntry &Entry = Entries[Slot];
+    if (str(Entry.OldName) != Name ||
+        Entry.Check > static_cast<uint32_t>(MigrationCheck::Pixels) ||
+        Entry.Kind > static_cast<uint32_t>(MigrationKind::TypeRename))
+      return std::nullopt;
+    return MigrationEntry{static_cast<MigrationCheck>(uint32_t(Entry.Check)),
+                          static_cast<MigrationKind>(uint32_t(Entry.Kind)),
+                          str(Entry.Header), str(Entry.OldName),
+                          str(Entry.NewName), str(Entry.Note)};
+  }
 
-    for (const auto &R : AudioFuncRenames) {
-      Finder->addMatcher(
-          callExpr(callee(functionDecl(hasName(R[0])))).bind(R[0]), this);
-    }
+  // Mask of the checks owning names declared in the header named Header
+  uint32_t checksOf(StringRef Header) const {
+    const DBHeaderRow *Row =
+        llvm::partition_point(Headers, [&](const DBHeaderRow &Row) {
+          return str(Row.Name) < Header;
+        });
+    if (Row == Headers.end() || str(Row->Name) != Header)
+      return 0;
+    return Row->CheckMask;
   }
 
-  void check(const ast_matchers::MatchFinder::MatchResult &Result) override {
-    if (const auto *Call = Result.Nodes.getNodeAs<CallExpr>("sdl_audio_init")) {
-      diag(Call->getBeginLoc(),
-           "SDL_AudioInit() has been removed in SDL3. "
-           "Use SDL_InitSubSystem(SDL_INIT_AUDIO) instead. "
-           "To choose a specific driver, use the SDL_AUDIO_DRIVER hint")
-          << FixItHint::CreateReplacement(Call->getSourceRange(),
-                                          "SDL_InitSubSystem(SDL_INIT_AUDIO)");
-      return;
+private:
+  using U32 = llvm::support::ulittle32_t;
+
+  struct DBString {
+    U32 Offset, Size; // into Strings
+  };
+  struct DBHeader {
+    char Magic[8]; // "SDL3MDB\0"
+    U32 Version, NumEntries, NumHeaders, StringsSize;
+  };
+  struct DBEntry {
+    U32 Check, Kind; // MigrationCheck, MigrationKind (a rename kind)
+    DBString Header, OldName, NewName, Note;
+  };
+  struct DBHeaderRow {
+    DBString Name;
+    U32 CheckMask; // MaskOf() the checks owning names it declares
+  };
+  static_assert(sizeof(DBHeader) == 24 && sizeof(DBEntry) == 40 &&
+                    sizeof(DBHeaderRow) == 12,
+                "must match the struct formats of compile_migration_db.py");
+
+  static constexpr uint32_t Version = 2; // 2: seeds of the finalized hash
+
+  explicit MigrationDatabase(llvm::sys::fs::mapped_file_region Region)
+      : Region(std::move(Region)) {}
+
+  static std::unique_ptr<MigrationDatabase> load(StringRef Path,
+                                                 std::string &Error) {
+    llvm::Expected<llvm::sys::fs::file_t> File =
+        llvm::sys::fs::openNativeFileForRead(Path);
+    if (!File) {
+      Error = llvm::toString(File.takeError());
+      return nullptr;
     }
-
-    if (const auto *Call = Result.Nodes.getNodeAs<CallExpr>("sdl_audio_quit")) {
-      diag(Call->getBeginLoc(), "SDL_AudioQuit() has been removed in SDL3. "
-                                "Use SDL_QuitSubSystem(SDL_INIT_AUDIO) instead")
-          << FixItHint::CreateReplacement(Call->getSourceRange(),
-                                          "SDL_QuitSubSystem(SDL_INIT_AUDIO)");
-      return;
+    uint64_t Size = 0;
+    std::error_code EC = llvm::sys::fs::file_size(Path, Size);
+    llvm::sys::fs::mapped_file_region Region;
+    if (!EC && Size >= sizeof(DBHeader))
+      Region = llvm::sys::fs::mapped_file_region(
+          *File, llvm::sys::fs::mapped_file_region::readonly, Size, 0, EC);
+    llvm::sys::fs::closeFile(*File);
+    if (EC) {
+      Error = EC.message();
+      return nullptr;
     }
+    std::unique_ptr<MigrationDatabase> Database(
+        new MigrationDatabase(std::move(Region)));
+    if (!Database->parse(Size, Error))
+      return nullptr;
+    return Database;
+  }
 
-    if (const auto *Call = Result.Nodes.getNodeAs<CallExpr>("sdl_free_wav")) {
-      diag(Call->getBeginLoc(),
-           "SDL_FreeWAV has been removed; replace with SDL_free")
-          << FixItHint::CreateReplacement(Call->getCallee()->getSourceRange(),
-                                          "SDL_free");
-      return;
+  bool parse(uint64_t Size, std::string &Error) {
+    if (Size < sizeof(DBHeader)) {
+      Error = "file too small";
+      return false;
     }
-
-    if (const auto *Call =
-            Result.Nodes.getNodeAs<CallExpr>("get_num_audio_devices")) {
-      const auto *DeviceType =
-          Result.Nodes.getNodeAs<IntegerLiteral>("device_type");
-      if (DeviceType) {
-        std::string replacement = (DeviceType->getValue() == 0)
-                                      ? "SDL_GetAudioPlaybackDevices"
-                                      : "SDL_GetAudioRecordingDevices";
-        diag(Call->getBeginLoc(),
-             "SDL_GetNumAudioDevices() has been removed in SDL3; "
-             "use %0(&num_devices) which returns an array of device IDs")
-            << replacement;
-      }
-      return;
+    const char *Data = Region.const_data();
+    const auto *Head = reinterpret_cast<const DBHeader *>(Data);
+    if (StringRef(Head->Magic, sizeof(Head->Magic)) !=
+        StringRef("SDL3MDB", 8)) {
+      Error = "not a migration database";
+      return false;
     }
-
-    if (const auto *Call =
-            Result.Nodes.getNodeAs<CallExpr>("sdl_pause_audio_device")) {
-      const auto *PauseValue =
-          Result.Nodes.getNodeAs<IntegerLiteral>("pause_value");
-      const auto *DeviceArg = Result.Nodes.getNodeAs<Expr>("device_arg");
-      if (PauseValue && DeviceArg) {
-        std::string DeviceText =
-            Lexer::getSourceText(
-                CharSourceRange::getTokenRange(DeviceArg->getSourceRange()),
-                *Result.SourceManager, Result.Context->getLangOpts())
-                .str();
-        if (PauseValue->getValue() == 0) {
-          diag(Call->getBeginLoc(),
-               "SDL_PauseAudioDevice() no longer takes a second argument; "
-               "use SDL_ResumeAudioDevice() to unpause")
-              << FixItHint::CreateReplacement(Call->getSourceRange(),
-                                              "SDL_ResumeAudioDevice(" +
-                                                  DeviceText + ")");
-        } else {
-          diag(Call->getBeginLoc(),
-               "SDL_PauseAudioDevice() no longer takes a second argument; "
-               "call SDL_PauseAudioDevice() with one argument to pause")
-              << FixItHint::CreateReplacement(Call->getSourceRange(),
-                                              "SDL_PauseAudioDevice(" +
-                                                  DeviceText + ")");
-        }
-      }
-      return;
+    if (Head->Version != Version) {
+      Error = "unsupported database version";
+      return false;
     }
-
-    if (const auto *Call =
-            Result.Nodes.getNodeAs<CallExpr>("sdl_get_audio_device_status")) {
-      const auto *DeviceArg = Result.Nodes.getNodeAs<Expr>("device_arg");
-      if (DeviceArg) {
-        std::string DeviceText =
-            Lexer::getSourceText(
-                CharSourceRange::getTokenRange(DeviceArg->getSourceRange()),
-                *Result.SourceManager, Result.Context->getLangOpts())
-                .str();
-        diag(Call->getBeginLoc(),
-             "SDL_GetAudioDeviceStatus() has been removed; "
-             "use SDL_AudioDevicePaused() which returns bool")
-            << FixItHint::CreateReplacement(Call->getSourceRange(),
-                                            "SDL_AudioDevicePaused(" +
-                                                DeviceText + ")");
-      }
-      return;
+    uint64_t NumEntries = Head->NumEntries, NumHeaders = Head->NumHeaders;
+    if (Size != sizeof(DBHeader) +
+                    NumEntries * (sizeof(DBEntry) + sizeof(int32_t)) +
+                    NumHeaders * sizeof(DBHeaderRow) + Head->StringsSize) {
+      Error = "truncated or corrupt database";
+      return false;
     }
+    const char *Next = Data + sizeof(DBHeader);
+    Entries =
+        ArrayRef<DBEntry>(reinterpret_cast<const DBEntry *>(Next), NumEntries);
+    Next += NumEntries * sizeof(DBEntry);
+    Seeds = ArrayRef<llvm::support::little32_t>(
+        reinterpret_cast<const llvm::support::little32_t *>(Next), NumEntries);
+    Next += NumEntries * sizeof(int32_t);
+    Headers = ArrayRef<DBHeaderRow>(
+        reinterpret_cast<const DBHeaderRow *>(Next), NumHeaders);
+    Next += NumHeaders * sizeof(DBHeaderRow);
+    Strings = StringRef(Next, Head->StringsSize);
+    return true;
+  }
 
-    for (const auto &S : AudioFormatMigrations) {
-      if (const auto *DRE = Result.Nodes.getNodeAs<DeclRefExpr>(S[0])) {
-        std::string Msg =
-            std::string(S[0]) + " has been renamed to " + S[1] + " in SDL3";
-        if (strlen(S[2]) > 0)
-          Msg += " (" + std::string(S[2]) + ")";
-        diag(DRE->getBeginLoc(), Msg)
-            << FixItHint::CreateReplacement(DRE->getSourceRange(), S[1]);
-        return;
-      }
-    }
+  // Strings out of range read as empty rather than past the mapping
+  StringRef str(const DBString &S) const {
+    if (S.Offset > Strings.size() || S.Size > Strings.size() - S.Offset)
+      return {};
+    return Strings.substr(S.Offset, S.Size);
+  }
 
-    for (const auto &R : AudioFuncRenames) {
-      if (const auto *Call = Result.Nodes.getNodeAs<CallExpr>(R[0])) {
-        diag(Call->getBeginLoc(), "%0() has been renamed to %1() in SDL3")
-            << R[0] << R[1]
-            << FixItHint::CreateReplacement(Call->getCallee()->getSourceRange(),
-                                            R[1]);
-        return;
-      }
+  llvm::sys::fs::mapped_file_region Region;
+  ArrayRef<DBEntry> Entries;
+  ArrayRef<llvm::support::little32_t> Seeds;
+  ArrayRef<DBHeaderRow> Headers;
+  StringRef Strings;
+};
+
+// ---------------------------------------------------------------------------
+// SDLHeaderCache: per-TU memo of which files are SDL2 headers; a decl counts as
+// SDL's when it is declared in one.
+// ---------------------------------------------------------------------------
+class SDLHeaderCache {
+public:
+  bool isSDLHeader(const SourceManager &SM, SourceLocation Loc) {
+    FileID FID = SM.getFileID(SM.getExpansionLoc(Loc));
+    auto [It, Inserted] = Files.try_emplace(FID, false);
+    if (Inserted) {
+      OptionalFileEntryRef File = SM.getFileEntryRefForID(FID);
+      It->second = File && IsSDL2Header(*File);
     }
+    return It->second;
+  }
 
-    if (const auto *Call =
-            Result.Nodes.getNodeAs<CallExpr>("sdl_mix_audio_format")) {
-      const auto *FormatArg = Result.Nodes.getNodeAs<Expr>("audio_format_arg");
+private:
+  llvm::DenseMap<FileID, bool> Files;
+};
 
-      std::string FormatText =
-          Lexer::getSourceText(
-              CharSourceRange::getTokenRange(FormatArg->getSourceRange()),
-              *Result.SourceManager, Result.Context->getLangOpts())
-              .str();
+// Helper: Entry if a check in CheckMask owns it
+template <typename Entry>
+static const Entry *OwnedBy(const Entry *E, uint32_t CheckMask) {
+  return E && (MaskOf(E->Check) & CheckMask) ? E : nullptr;
+}
 
-      const auto *VolumeArg = Result.Nodes.getNodeAs<Expr>("audio_volume");
-      std::string VolumeText =
-          Lexer::getSourceText(
-              CharSourceRange::getTokenRange(VolumeArg->getSourceRange()),
-              *Result.SourceManager, Result.Context->getLangOpts())
-              .str();
-      if (VolumeText == "SDL_MIX_MAXVOLUME") {
-        VolumeText = "1.0f";
-      } else {
-        VolumeText = "(float)" + VolumeText + " / 128";
-      }
-      // Look up and replace audio format symbol
-      for (const auto &S : AudioFormatMigrations) {
-        if (FormatText == S[0]) {
-          FormatText = S[1];
-          break;
-        }
-      }
+// ---------------------------------------------------------------------------
+// SDLDeclMemo: per-TU memo of the table rows of a decl. The first reference to
+// a decl pays for the SDL2 header test and the name lookups; every later one
+// is a single DenseMap probe. Decls without rows (user code, the C library)
+// are memoized too. Rows of the migration databases are copied into the memo,
+// as the databases hold no MigrationEntry.
+// ---------------------------------------------------------------------------
+class SDLDeclMemo {
+public:
+  struct Rows {
+    const MigrationEntry *Row = nullptr;        // SDLMigrations
+    const MigrationEntry *BoolReturn = nullptr; // SDLBoolReturns
+    const CallRewriteSet *Rewrites = nullptr;   // SDLCallRewrites
+
+    // Row, if a check in CheckMask owns it and it is of a kind in KindMask
+    const MigrationEntry *row(uint32_t CheckMask, uint32_t KindMask) const {
+      return OwnedBy(Row, CheckMask) && (MaskOf(Row->Kind) & KindMask)
+                 ? Row
+                 : nullptr;
+    }
+    const MigrationEntry *boolReturn(uint32_t CheckMask) const {
+      return OwnedBy(BoolReturn, CheckMask);
+    }
+    const CallRewriteSet *rewrites(uint32_t CheckMask) const {
+      return OwnedBy(Rewrites, CheckMask);
+    }
+  };
 
-      std::string Replacement = "SDL_MixAudio";
+  explicit SDLDeclMemo(SDLHeaderCache &Headers) : Headers(Headers) {}
 
-      diag(Call->getBeginLoc(), "SDL_MixAudioFormat() has been removed in "
-                                "SDL3. Use SDL_MixAudio() instead and change "
-                                "the arguments appropriately")
-          << FixItHint::CreateReplacement(Call->getCallee()->getSourceRange(),
-                                          Replacement)
-          << FixItHint::CreateReplacement(FormatArg->getSourceRange(),
-                                          FormatText)
-          << FixItHint::CreateReplacement(VolumeArg->getSourceRange(),
-                                          VolumeText);
+  Rows lookup(const NamedDecl *D, const SourceManager &SM) {
+    auto [It, Inserted] = Decls.try_emplace(D);
+    if (!Inserted) {
+      ++Hits;
+      return It->second;
     }
-    if (const auto *Call =
-            Result.Nodes.getNodeAs<CallExpr>("sdl_new_audio_stream")) {
-      // Extract argument text
-      const auto *SrcFormat = Result.Nodes.getNodeAs<Expr>("src_format");
-      const auto *SrcChannels = Result.Nodes.getNodeAs<Expr>("src_channels");
-      const auto *SrcRate = Result.Nodes.getNodeAs<Expr>("src_rate");
-      const auto *DstFormat = Result.Nodes.getNodeAs<Expr>("dst_format");
-      const auto *DstChannels = Result.Nodes.getNodeAs<Expr>("dst_channels");
-      const auto *DstRate = Result.Nodes.getNodeAs<Expr>("dst_rate");
-
-      std::string SrcFormatText =
-          Lexer::getSourceText(
-              CharSourceRange::getTokenRange(SrcFormat->getSourceRange()),
-              *Result.SourceManager, Result.Context->getLangOpts())
-              .str();
-      std::string SrcChannelsText =
-          Lexer::getSourceText(
-              CharSourceRange::getTokenRange(SrcChannels->getSourceRange()),
-              *Result.SourceManager, Result.Context->getLangOpts())
-              .str();
-      std::string SrcRateText =
-          Lexer::getSourceText(
-              CharSourceRange::getTokenRange(SrcRate->getSourceRange()),
-              *Result.SourceManager, Result.Context->getLangOpts())
-              .str();
-      std::string DstFormatText =
-          Lexer::getSourceText(
-              CharSourceRange::getTokenRange(DstFormat->getSourceRange()),
-              *Result.SourceManager, Result.Context->getLangOpts())
-              .str();
-      std::string DstChannelsText =
-          Lexer::getSourceText(
-              CharSourceRange::getTokenRange(DstChannels->getSourceRange()),
-              *Result.SourceManager, Result.Context->getLangOpts())
-              .str();
-      std::string DstRateText =
-          Lexer::getSourceText(
-              CharSourceRange::getTokenRange(DstRate->getSourceRange()),
-              *Result.SourceManager, Result.Context->getLangOpts())
-              .str();
-
-      for (const auto &S : AudioFormatMigrations) {
-        if (SrcFormatText == S[0]) {
-          SrcFormatText = S[1];
-        }
-        if (DstFormatText == S[0]) {
-          DstFormatText = S[1];
-        }
-      }
-      // Find the statement containing this call
-      auto Parents = Result.Context->getParents(*Call);
-      const Stmt *ContainingStmt = nullptr;
-
-      while (!Parents.empty()) {
-        const auto &Parent = Parents[0];
-        if (const auto *S = Parent.get<Stmt>()) {
-          if (isa<DeclStmt>(S) || isa<Expr>(S)) {
-            ContainingStmt = S;
-            auto NextParents = Result.Context->getParents(Parent);
-            if (!NextParents.empty() && NextParents[0].get<CompoundStmt>()) {
-              break;
-            }
-          }
-        }
-        Parents = Result.Context->getParents(Parent);
-      }
-
-      if (ContainingStmt) {
-        SourceLocation StmtBegin = ContainingStmt->getBeginLoc();
+    ++Misses;
+    Rows &Found = It->second;
+    if (!D->getIdentifier())
+      return Found;
+    StringRef Name = D->getName();
+    if (Headers.isSDLHeader(SM, D->getLocation())) {
+      Found.Row = SDLMigrations.lookup(Name);
+      Found.BoolReturn = SDLBoolReturns.lookup(Name);
+      Found.Rewrites = SDLCallRewrites.lookup(Name);
+    }
+    if (!Found.Row)
+      Found.Row = databaseRow(Name, D->getLocation(), SM);
+    return Found;
+  }
 
-        std::string VarDecls = "SDL_AudioSpec srcspec = {" + SrcFormatText +
-                               ", " + SrcChannelsText + ", " + SrcRateText +
-                               "};\n"
-                               "  SDL_AudioSpec dstspec = {" +
-                               DstFormatText + ", " + DstChannelsText + ", " +
-                               DstRateText +
-                               "};\n"
-                               "  ";
+  void addDatabase(const MigrationDatabase *Database) {
+    if (!llvm::is_contained(Databases, Database))
+      Databases.push_back(Database);
+  }
+  ArrayRef<const MigrationDatabase *> databases() const { return Databases; }
 
-        std::string Replacement = "SDL_CreateAudioStream(&srcspec, &dstspec)";
+  unsigned hits() const { return Hits; }
+  unsigned misses() const { return Misses; }
 
-        diag(Call->getBeginLoc(),
-             "SDL_NewAudioStream() has been replaced in SDL3. "
-             "Use SDL_CreateAudioStream() with SDL_AudioSpec structures")
-            << FixItHint::CreateInsertion(StmtBegin, VarDecls)
-            << FixItHint::CreateReplacement(Call->getSourceRange(),
-                                            Replacement);
-      }
+private:
+  // Row of Name in the databases, if it applies to a decl at Loc: one in an
+  // SDL2 header or in the header the row names
+  const MigrationEntry *databaseRow(StringRef Name, SourceLocation Loc,
+                                    const SourceManager &SM) {
+    for (const MigrationDatabase *Database : Databases) {
+      std::optional<MigrationEntry> Row = Database->lookup(Name);
+      if (!Row)
+        continue;
+      StringRef File = SM.getFilename(SM.getExpansionLoc(Loc));
+      if (llvm::sys::path::filename(File) == Row->Header ||
+          Headers.isSDLHeader(SM, Loc))
+        return &DatabaseRows.emplace_back(*Row);
     }
+    return nullptr;
   }
+
+  SDLHeaderCache &Headers;
+  llvm::DenseMap<const NamedDecl *, Rows> Decls;
+  llvm::SmallVector<const MigrationDatabase *, 1> Databases;
+  std::deque<MigrationEntry> DatabaseRows; // stable addresses
+  unsigned Hits = 0;
+  unsigned Misses = 0;
 };
 
+// Helper: a new <Directory>/<main file>-XXXXXX.json for a report on the TU
+// of MainFile, or null (after telling why on stderr). What: the report, for
+// the error message.
+static std::unique_ptr<llvm::raw_fd_ostream>
+CreateReportFile(StringRef Directory, StringRef MainFile, StringRef What) {
+  llvm::SmallString<256> Model(Directory);
+  llvm::sys::path::append(Model, llvm::sys::path::filename(MainFile) +
+                                     "-%%%%%%.json");
+  int FD = -1;
+  llvm::SmallString<256> Path;
+  std::error_code EC = llvm::sys::fs::create_directories(Directory);
+  if (!EC)
+    EC = llvm::sys::fs::createUniqueFile(Model, FD, Path);
+  if (EC) {
+    llvm::errs() << "cannot write " << What << " to '" << Directory
+                 << "': " << EC.message() << "\n";
+    return nullptr;
+  }
+  return std::make_unique<llvm::raw_fd_ostream>(FD, /*shouldClose=*/true);
+}
+
 // ---------------------------------------------------------------------------
-// SDL3InitCheck  (SDL_init.h + error-checking patterns + endian + cpuinfo)
+// SDLStats: per-TU hit counts and time of every migration table row and
+// subsystem handler, kept when the StatsDirectory option is set and written
+// there as JSON at the end of the TU; tools/aggregate_migration_stats.py sums
+// the files of a run. Times are those of the check() callbacks (building the
+// diagnostic and its fixes); matcher evaluation stays in clang-tidy's
+// --enable-check-profile.
 // ---------------------------------------------------------------------------
-class SDL3InitCheck : public ClangTidyCheck {
+class SDLStats {
 public:
-  SDL3InitCheck(StringRef Name, ClangTidyContext *Context)
-      : ClangTidyCheck(Name, Context) {}
-
-  void registerMatchers(ast_matchers::MatchFinder *Finder) override {
-    // SDL3 functions return bool; match old SDL2 error-check patterns
-    Finder->addMatcher(
-        ifStmt(hasCondition(binaryOperator(
-                   hasOperatorName("=="),
-                   hasLHS(callExpr(callee(implicitCastExpr(
-                       hasCastKind(CK_FunctionToPointerDecay),
-                       hasSourceExpression(declRefExpr(
-                           to(functionDecl(matchesName("SDL_[A-Z].*"))))))))),
-                   hasRHS(unaryOperator(
-                       hasOperatorName("-"),
-                       hasUnaryOperand(integerLiteral(equals(1))))))))
-            .bind("sdl_error_check_minus_one"),
-        this);
-
-    Finder->addMatcher(
-        ifStmt(hasCondition(binaryOperator(
-                   hasOperatorName("<"),
-                   hasLHS(callExpr(callee(implicitCastExpr(
-                       hasCastKind(CK_FunctionToPointerDecay),
-                       hasSourceExpression(declRefExpr(
-                           to(functionDecl(matchesName("SDL_[A-Z].*"))))))))),
-                   hasRHS(integerLiteral(equals(0))))))
-            .bind("sdl_error_check_negative"),
-        this);
-
-    Finder->addMatcher(
-        ifStmt(hasCondition(binaryOperator(
-                   hasOperatorName("=="),
-                   hasLHS(callExpr(callee(implicitCastExpr(
-                       hasCastKind(CK_FunctionToPointerDecay),
-                       hasSourceExpression(declRefExpr(
-                           to(functionDecl(matchesName("SDL_[A-Z].*"))))))))),
-                   hasRHS(integerLiteral(equals(0))))))
-            .bind("sdl_error_check_zero"),
-        this);
-
-    Finder->addMatcher(
-        ifStmt(hasCondition(unaryOperator(
-                   hasOperatorName("!"),
-                   hasUnaryOperand(implicitCastExpr(
-                       hasCastKind(CK_IntegralToBoolean),
-                       hasSourceExpression(callExpr(callee(implicitCastExpr(
-                           hasCastKind(CK_FunctionToPointerDecay),
-                           hasSourceExpression(declRefExpr(to(functionDecl(
-                               matchesName("SDL_[A-Z].*"))))))))))))))
-            .bind("sdl_error_check_negation"),
-        this);
-
-    for (const auto &R : FunctionRenames) {
-      Finder->addMatcher(
-          callExpr(callee(functionDecl(hasName(R[0])))).bind(R[0]), this);
+  using Clock = std::chrono::steady_clock;
+
+  // Times its lifetime and counts it, as one hit, against the row or handler
+  // named by the last charge() inside it. Scopes nest; an outer one includes
+  // the time of the inner ones. Does nothing when Stats is null.
+  class Scope {
+  public:
+    Scope(SDLStats *Stats, StringRef Check) : Stats(Stats), Check(Check) {
+      if (!Stats)
+        return;
+      Outer = Innermost;
+      Innermost = this;
+      Start = Clock::now();
     }
+    Scope(const Scope &) = delete;
+    Scope &operator=(const Scope &) = delete;
 
-    for (const auto &Rem : RemovedFunctions) {
-      Finder->addMatcher(
-          callExpr(callee(functionDecl(hasName(Rem[0])))).bind(Rem[0]), this);
+    ~Scope() {
+      if (!Stats)
+        return;
+      Innermost = Outer;
+      if (Kind.empty())
+        return;
+      Counter &C = Stats->Counters[{Check.str(), Kind.str(), Name.str()}];
+      ++C.Hits;
+      C.Nanoseconds += std::chrono::duration_cast<std::chrono::nanoseconds>(
+                           Clock::now() - Start)
+                           .count();
     }
 
-    for (const auto &S : SymbolMigrations) {
-      Finder->addMatcher(declRefExpr(to(namedDecl(hasName(S[0])))).bind(S[0]),
-                         this);
+  private:
+    friend class SDLStats;
+    SDLStats *Stats;
+    StringRef Check;
+    StringRef Kind, Name; // set by charge()
+    Scope *Outer = nullptr;
+    Clock::time_point Start;
+  };
+
+  // Names what the innermost Scope is counted against. Kind: the row kind
+  // ("function", "removed", "symbol", "type", "rewrite") or "handler", for
+  // the subsystem matchers.
+  static void charge(StringRef Kind, StringRef Name) {
+    if (Innermost) {
+      Innermost->Kind = Kind;
+      Innermost->Name = Name;
     }
   }
 
-  void registerPPCallbacks(const SourceManager &SM, Preprocessor *PP,
-                           Preprocessor *ModuleExpanderPP) override {
-    PP->addPPCallbacks(::std::make_unique<SDLIncludeCallback>(*this, SM));
+  // Writes the counters to a new <Directory>/<main file>-XXXXXX.json
+  void write(StringRef Directory, StringRef MainFile) const {
+    auto OS = CreateReportFile(Directory, MainFile, "migration stats");
+    if (!OS)
+      return;
+    llvm::json::OStream JSON(*OS, /*IndentSize=*/2);
+    JSON.object([&] {
+      JSON.attribute("file", MainFile);
+      JSON.attributeArray("counters", [&] {
+        for (const auto &[Key, C] : Counters)
+          JSON.object([&, &Key = Key, &C = C] {
+            JSON.attribute("check", std::get<0>(Key));
+            JSON.attribute("kind", std::get<1>(Key));
+            JSON.attribute("name", std::get<2>(Key));
+            JSON.attribute("hits", static_cast<int64_t>(C.Hits));
+            JSON.attribute("ns", static_cast<int64_t>(C.Nanoseconds));
+          });
+      });
+    });
   }
 
-  void check(const ast_matchers::MatchFinder::MatchResult &Result) override {
-    if (const auto *IfS =
-            Result.Nodes.getNodeAs<IfStmt>("sdl_error_check_minus_one")) {
-      const auto *Cond = IfS->getCond();
-      if (const auto *BinOp = dyn_cast<BinaryOperator>(Cond)) {
-        if (const auto *Call =
-                dyn_cast<CallExpr>(BinOp->getLHS()->IgnoreParenImpCasts())) {
-          std::string CallText =
-              Lexer::getSourceText(
-                  CharSourceRange::getTokenRange(Call->getSourceRange()),
-                  *Result.SourceManager, Result.Context->getLangOpts())
-                  .str();
-          diag(IfS->getIfLoc(),
-               "SDL3 functions that returned a negative error now return bool; "
-               "remove '== -1' and negate to indicate failure")
-              << FixItHint::CreateReplacement(Cond->getSourceRange(),
-                                              "!" + CallText);
-        }
-      }
-      return;
-    }
+private:
+  struct Counter {
+    uint64_t Hits = 0;
+    uint64_t Nanoseconds = 0;
+  };
 
-    if (const auto *IfS =
-            Result.Nodes.getNodeAs<IfStmt>("sdl_error_check_negative")) {
-      const auto *Cond = IfS->getCond();
-      if (const auto *BinOp = dyn_cast<BinaryOperator>(Cond)) {
-        if (const auto *Call =
-                dyn_cast<CallExpr>(BinOp->getLHS()->IgnoreParenImpCasts())) {
-          std::string CallText =
-              Lexer::getSourceText(
-                  CharSourceRange::getTokenRange(Call->getSourceRange()),
-                  *Result.SourceManager, Result.Context->getLangOpts())
-                  .str();
-          diag(IfS->getIfLoc(),
-               "SDL3 functions that returned a negative error now return bool; "
-               "remove '< 0' and negate to indicate failure")
-              << FixItHint::CreateReplacement(Cond->getSourceRange(),
-                                              "!" + CallText);
-        }
-      }
-      return;
-    }
+  static inline thread_local Scope *Innermost = nullptr;
 
-    if (const auto *IfS =
-            Result.Nodes.getNodeAs<IfStmt>("sdl_error_check_zero")) {
-      const auto *Cond = IfS->getCond();
-      if (const auto *BinOp = dyn_cast<BinaryOperator>(Cond)) {
-        if (const auto *Call =
-                dyn_cast<CallExpr>(BinOp->getLHS()->IgnoreParenImpCasts())) {
-          std::string CallText =
-              Lexer::getSourceText(
-                  CharSourceRange::getTokenRange(Call->getSourceRange()),
-                  *Result.SourceManager, Result.Context->getLangOpts())
-                  .str();
-          diag(IfS->getIfLoc(),
-               "SDL3 functions that returned 0 for success now return bool; "
-               "remove '== 0' for the success branch")
-              << FixItHint::CreateReplacement(Cond->getSourceRange(), CallText);
-        }
-      }
-      return;
-    }
+  // (check, kind, name), ordered so the files diff well
+  std::map<std::tuple<std::string, std::string, std::string>, Counter>
+      Counters;
+};
 
-    if (const auto *IfS =
-            Result.Nodes.getNodeAs<IfStmt>("sdl_error_check_negation")) {
-      const auto *Cond = IfS->getCond();
-      if (const auto *UnaryOp =
-              dyn_cast<UnaryOperator>(Cond->IgnoreParenImpCasts())) {
-        if (const auto *Call = dyn_cast<CallExpr>(
-                UnaryOp->getSubExpr()->IgnoreParenImpCasts())) {
-          std::string CallText =
-              Lexer::getSourceText(
-                  CharSourceRange::getTokenRange(Call->getSourceRange()),
-                  *Result.SourceManager, Result.Context->getLangOpts())
-                  .str();
-          diag(IfS->getIfLoc(),
-               "SDL3 functions that returned 0 for success now return bool; "
-               "remove '!' for the success branch")
-              << FixItHint::CreateReplacement(Cond->getSourceRange(), CallText);
-        }
-      }
-      return;
-    }
+// Helper: Kind as SDLStats::charge() names it
+static StringRef KindName(MigrationKind Kind) {
+  switch (Kind) {
+  case MigrationKind::FunctionRename:
+    return "function";
+  case MigrationKind::RemovedFunction:
+    return "removed";
+  case MigrationKind::SymbolRename:
+    return "symbol";
+  case MigrationKind::TypeRename:
+    return "type";
+  case MigrationKind::BoolReturn:
+    return "bool";
+  }
+  llvm_unreachable("unknown MigrationKind");
+}
 
-    for (const auto &R : FunctionRenames) {
-      if (const auto *Call = Result.Nodes.getNodeAs<CallExpr>(R[0])) {
-        std::string Msg =
-            std::string(R[0]) + "() has been renamed to " + R[1] + "() in SDL3";
-        if (strlen(R[2]) > 0)
-          Msg += " (" + std::string(R[2]) + ")";
-        diag(Call->getBeginLoc(), Msg) << FixItHint::CreateReplacement(
-            Call->getCallee()->getSourceRange(), R[1]);
-        return;
-      }
-    }
+// ---------------------------------------------------------------------------
+// SDLTrace: a Chrome trace event timeline of the TU on this thread, kept when
+// the TraceDirectory option is set and written there at the end of the TU.
+// It spans the TU and, inside it, the checks' preprocessor callbacks, matcher
+// registration, AST matching and, inside that, the check() callbacks and the
+// building of the table rows' fixes; the gaps are Clang's own parsing and
+// Sema. It is recorded by LLVM's time trace profiler, the one behind
+// -ftime-trace, so it loads in the same viewers; spans shorter than
+// TraceGranularityMicroseconds only add to the trace's per-phase totals. When
+// the profiler already runs on the thread (a host compiling with
+// -ftime-trace), the spans go into that trace instead.
+// ---------------------------------------------------------------------------
+class SDLTrace {
+public:
+  // clang's -ftime-trace-granularity default
+  static constexpr unsigned TraceGranularityMicroseconds = 500;
 
-    for (const auto &Rem : RemovedFunctions) {
-      if (const auto *Call = Result.Nodes.getNodeAs<CallExpr>(Rem[0])) {
-        diag(Call->getBeginLoc(),
-             "%0() has been removed in SDL3; see migration guide")
-            << Rem[0];
-        return;
-      }
-    }
+  // Starts a trace of the TU into Directory, if not empty. The checks call it
+  // as clang-tidy creates them for the TU, before it does anything else.
+  static void start(StringRef Directory) {
+    if (Directory.empty() || llvm::timeTraceProfilerEnabled())
+      return;
+    llvm::timeTraceProfilerInitialize(TraceGranularityMicroseconds,
+                                      "clang-tidy");
+    OwnedDirectory = Directory.str();
+    llvm::timeTraceProfilerBegin("SDL3 translation unit", "");
+  }
 
-    for (const auto &S : SymbolMigrations) {
-      if (const auto *DRE = Result.Nodes.getNodeAs<DeclRefExpr>(S[0])) {
-        std::string Msg =
-            std::string(S[0]) + " has been renamed to " + S[1] + " in SDL3";
-        if (strlen(S[2]) > 0)
-          Msg += " (" + std::string(S[2]) + ")";
-        diag(DRE->getBeginLoc(), Msg)
-            << FixItHint::CreateReplacement(DRE->getSourceRange(), S[1]);
-        return;
-      }
-    }
+  // Brackets MatchFinder's traversal of the TU; the first check told of
+  // either end decides
+  static void startMatching() {
+    if (!llvm::timeTraceProfilerEnabled() || Matching)
+      return;
+    llvm::timeTraceProfilerBegin("SDL3 AST matching", "");
+    Matching = true;
+  }
+  static void finishMatching() {
+    if (!Matching)
+      return;
+    llvm::timeTraceProfilerEnd();
+    Matching = false;
   }
-};
 
-// ===========================================================================
-// SDL3GamepadCheck  (SDL_gamecontroller.h -> SDL_gamepad.h)
-// ===========================================================================
-static const char *GamepadFuncRenames[][2] = {
-    {"SDL_GameControllerAddMapping", "SDL_AddGamepadMapping"},
-    {"SDL_GameControllerAddMappingsFromFile", "SDL_AddGamepadMappingsFromFile"},
-    {"SDL_GameControllerAddMappingsFromRW", "SDL_AddGamepadMappingsFromIO"},
-    {"SDL_GameControllerClose", "SDL_CloseGamepad"},
-    {"SDL_GameControllerFromInstanceID", "SDL_GetGamepadFromID"},
-    {"SDL_GameControllerFromPlayerIndex", "SDL_GetGamepadFromPlayerIndex"},
-    {"SDL_GameControllerGetAppleSFSymbolsNameForAxis",
-     "SDL_GetGamepadAppleSFSymbolsNameForAxis"},
-    {"SDL_GameControllerGetAppleSFSymbolsNameForButton",
-     "SDL_GetGamepadAppleSFSymbolsNameForButton"},
-    {"SDL_GameControllerGetAttached", "SDL_GamepadConnected"},
-    {"SDL_GameControllerGetAxis", "SDL_GetGamepadAxis"},
-    {"SDL_GameControllerGetAxisFromString", "SDL_GetGamepadAxisFromString"},
-    {"SDL_GameControllerGetButton", "SDL_GetGamepadButton"},
-    {"SDL_GameControllerGetButtonFromString", "SDL_GetGamepadButtonFromString"},
-    {"SDL_GameControllerGetFirmwareVersion", "SDL_GetGamepadFirmwareVersion"},
-    {"SDL_GameControllerGetJoystick", "SDL_GetGamepadJoystick"},
-    {"SDL_GameControllerGetNumTouchpadFingers",
-     "SDL_GetNumGamepadTouchpadFingers"},
-    {"SDL_GameControllerGetNumTouchpads", "SDL_GetNumGamepadTouchpads"},
-    {"SDL_GameControllerGetPlayerIndex", "SDL_GetGamepadPlayerIndex"},
-    {"SDL_GameControllerGetProduct", "SDL_GetGamepadProduct"},
-    {"SDL_GameControllerGetProductVersion", "SDL_GetGamepadProductVersion"},
-    {"SDL_GameControllerGetSensorData", "SDL_GetGamepadSensorData"},
-    {"SDL_GameControllerGetSensorDataRate", "SDL_GetGamepadSensorDataRate"},
-    {"SDL_GameControllerGetSerial", "SDL_GetGamepadSerial"},
-    {"SDL_GameControllerGetSteamHandle", "SDL_GetGamepadSteamHandle"},
-    {"SDL_GameControllerGetStringForAxis", "SDL_GetGamepadStringForAxis"},
-    {"SDL_GameControllerGetStringForButton", "SDL_GetGamepadStringForButton"},
-    {"SDL_GameControllerGetTouchpadFinger", "SDL_GetGamepadTouchpadFinger"},
-    {"SDL_GameControllerGetType", "SDL_GetGamepadType"},
-    {"SDL_GameControllerGetVendor", "SDL_GetGamepadVendor"},
-    {"SDL_GameControllerHasAxis", "SDL_GamepadHasAxis"},
-    {"SDL_GameControllerHasButton", "SDL_GamepadHasButton"},
-    {"SDL_GameControllerHasSensor", "SDL_GamepadHasSensor"},
-    {"SDL_GameControllerIsSensorEnabled", "SDL_GamepadSensorEnabled"},
-    {"SDL_GameControllerMapping", "SDL_GetGamepadMapping"},
-    {"SDL_GameControllerMappingForGUID", "SDL_GetGamepadMappingForGUID"},
-    {"SDL_GameControllerName", "SDL_GetGamepadName"},
-    {"SDL_GameControllerOpen", "SDL_OpenGamepad"},
-    {"SDL_GameControllerPath", "SDL_GetGamepadPath"},
-    {"SDL_GameControllerRumble", "SDL_RumbleGamepad"},
-    {"SDL_GameControllerRumbleTriggers", "SDL_RumbleGamepadTriggers"},
-    {"SDL_GameControllerSendEffect", "SDL_SendGamepadEffect"},
-    {"SDL_GameControllerSetLED", "SDL_SetGamepadLED"},
-    {"SDL_GameControllerSetPlayerIndex", "SDL_SetGamepadPlayerIndex"},
-    {"SDL_GameControllerSetSensorEnabled", "SDL_SetGamepadSensorEnabled"},
-    {"SDL_GameControllerUpdate", "SDL_UpdateGamepads"},
-    {"SDL_IsGameController", "SDL_IsGamepad"},
-};
+  // Ends the trace start() began and writes it to a new
+  // <Directory>/<main file>-XXXXXX.json
+  static void finish(StringRef MainFile) {
+    if (OwnedDirectory.empty())
+      return;
+    finishMatching();
+    llvm::timeTraceProfilerEnd();
+    if (auto OS = CreateReportFile(OwnedDirectory, MainFile, "trace"))
+      llvm::timeTraceProfilerWrite(*OS);
+    discard();
+  }
 
-static const char *GamepadRemovedFuncs[] = {
-    "SDL_GameControllerEventState",
-    "SDL_GameControllerGetBindForAxis",
-    "SDL_GameControllerGetBindForButton",
-    "SDL_GameControllerHasLED",
-    "SDL_GameControllerHasRumble",
-    "SDL_GameControllerHasRumbleTriggers",
-    "SDL_GameControllerMappingForDeviceIndex",
-    "SDL_GameControllerMappingForIndex",
-    "SDL_GameControllerNameForIndex",
-    "SDL_GameControllerNumMappings",
-    "SDL_GameControllerPathForIndex",
-    "SDL_GameControllerTypeForIndex",
-    "SDL_GameControllerGetSensorDataWithTimestamp",
-};
+  // Drops the trace start() began, if the TU ended without finish()
+  static void discard() {
+    if (OwnedDirectory.empty())
+      return;
+    llvm::timeTraceProfilerCleanup();
+    OwnedDirectory.clear();
+    Matching = false;
+  }
 
-static const char *GamepadSymbolRenames[][2] = {
-    {"SDL_CONTROLLER_AXIS_INVALID", "SDL_GAMEPAD_AXIS_INVALID"},
-    {"SDL_CONTROLLER_AXIS_LEFTX", "SDL_GAMEPAD_AXIS_LEFTX"},
-    {"SDL_CONTROLLER_AXIS_LEFTY", "SDL_GAMEPAD_AXIS_LEFTY"},
-    {"SDL_CONTROLLER_AXIS_MAX", "SDL_GAMEPAD_AXIS_COUNT"},
-    {"SDL_CONTROLLER_AXIS_RIGHTX", "SDL_GAMEPAD_AXIS_RIGHTX"},
-    {"SDL_CONTROLLER_AXIS_RIGHTY", "SDL_GAMEPAD_AXIS_RIGHTY"},
-    {"SDL_CONTROLLER_AXIS_TRIGGERLEFT", "SDL_GAMEPAD_AXIS_LEFT_TRIGGER"},
-    {"SDL_CONTROLLER_AXIS_TRIGGERRIGHT", "SDL_GAMEPAD_AXIS_RIGHT_TRIGGER"},
-    {"SDL_CONTROLLER_BINDTYPE_AXIS", "SDL_GAMEPAD_BINDTYPE_AXIS"},
-    {"SDL_CONTROLLER_BINDTYPE_BUTTON", "SDL_GAMEPAD_BINDTYPE_BUTTON"},
-    {"SDL_CONTROLLER_BINDTYPE_HAT", "SDL_GAMEPAD_BINDTYPE_HAT"},
-    {"SDL_CONTROLLER_BINDTYPE_NONE", "SDL_GAMEPAD_BINDTYPE_NONE"},
-    {"SDL_CONTROLLER_BUTTON_A", "SDL_GAMEPAD_BUTTON_SOUTH"},
-    {"SDL_CONTROLLER_BUTTON_B", "SDL_GAMEPAD_BUTTON_EAST"},
-    {"SDL_CONTROLLER_BUTTON_BACK", "SDL_GAMEPAD_BUTTON_BACK"},
-    {"SDL_CONTROLLER_BUTTON_DPAD_DOWN", "SDL_GAMEPAD_BUTTON_DPAD_DOWN"},
-    {"SDL_CONTROLLER_BUTTON_DPAD_LEFT", "SDL_GAMEPAD_BUTTON_DPAD_LEFT"},
-    {"SDL_CONTROLLER_BUTTON_DPAD_RIGHT", "SDL_GAMEPAD_BUTTON_DPAD_RIGHT"},
-    {"SDL_CONTROLLER_BUTTON_DPAD_UP", "SDL_GAMEPAD_BUTTON_DPAD_UP"},
-    {"SDL_CONTROLLER_BUTTON_GUIDE", "SDL_GAMEPAD_BUTTON_GUIDE"},
-    {"SDL_CONTROLLER_BUTTON_INVALID", "SDL_GAMEPAD_BUTTON_INVALID"},
-    {"SDL_CONTROLLER_BUTTON_LEFTSHOULDER", "SDL_GAMEPAD_BUTTON_LEFT_SHOULDER"},
-    {"SDL_CONTROLLER_BUTTON_LEFTSTICK", "SDL_GAMEPAD_BUTTON_LEFT_STICK"},
-    {"SDL_CONTROLLER_BUTTON_MAX", "SDL_GAMEPAD_BUTTON_COUNT"},
-    {"SDL_CONTROLLER_BUTTON_MISC1", "SDL_GAMEPAD_BUTTON_MISC1"},
-    {"SDL_CONTROLLER_BUTTON_PADDLE1", "SDL_GAMEPAD_BUTTON_RIGHT_PADDLE1"},
-    {"SDL_CONTROLLER_BUTTON_PADDLE2", "SDL_GAMEPAD_BUTTON_LEFT_PADDLE1"},
-    {"SDL_CONTROLLER_BUTTON_PADDLE3", "SDL_GAMEPAD_BUTTON_RIGHT_PADDLE2"},
-    {"SDL_CONTROLLER_BUTTON_PADDLE4", "SDL_GAMEPAD_BUTTON_LEFT_PADDLE2"},
-    {"SDL_CONTROLLER_BUTTON_RIGHTSHOULDER",
-     "SDL_GAMEPAD_BUTTON_RIGHT_SHOULDER"},
-    {"SDL_CONTROLLER_BUTTON_RIGHTSTICK", "SDL_GAMEPAD_BUTTON_RIGHT_STICK"},
-    {"SDL_CONTROLLER_BUTTON_START", "SDL_GAMEPAD_BUTTON_START"},
-    {"SDL_CONTROLLER_BUTTON_TOUCHPAD", "SDL_GAMEPAD_BUTTON_TOUCHPAD"},
-    {"SDL_CONTROLLER_BUTTON_X", "SDL_GAMEPAD_BUTTON_WEST"},
-    {"SDL_CONTROLLER_BUTTON_Y", "SDL_GAMEPAD_BUTTON_NORTH"},
-    {"SDL_CONTROLLER_TYPE_NINTENDO_SWITCH_JOYCON_LEFT",
-     "SDL_GAMEPAD_TYPE_NINTENDO_SWITCH_JOYCON_LEFT"},
-    {"SDL_CONTROLLER_TYPE_NINTENDO_SWITCH_JOYCON_PAIR",
-     "SDL_GAMEPAD_TYPE_NINTENDO_SWITCH_JOYCON_PAIR"},
-    {"SDL_CONTROLLER_TYPE_NINTENDO_SWITCH_JOYCON_RIGHT",
-     "SDL_GAMEPAD_TYPE_NINTENDO_SWITCH_JOYCON_RIGHT"},
-    {"SDL_CONTROLLER_TYPE_NINTENDO_SWITCH_PRO",
-     "SDL_GAMEPAD_TYPE_NINTENDO_SWITCH_PRO"},
-    {"SDL_CONTROLLER_TYPE_PS3", "SDL_GAMEPAD_TYPE_PS3"},
-    {"SDL_CONTROLLER_TYPE_PS4", "SDL_GAMEPAD_TYPE_PS4"},
-    {"SDL_CONTROLLER_TYPE_PS5", "SDL_GAMEPAD_TYPE_PS5"},
-    {"SDL_CONTROLLER_TYPE_UNKNOWN", "SDL_GAMEPAD_TYPE_STANDARD"},
-    {"SDL_CONTROLLER_TYPE_XBOX360", "SDL_GAMEPAD_TYPE_XBOX360"},
-    {"SDL_CONTROLLER_TYPE_XBOXONE", "SDL_GAMEPAD_TYPE_XBOXONE"},
+private:
+  static inline thread_local std::string OwnedDirectory; // empty: not ours
+  static inline thread_local bool Matching = false;
 };
 
-class SDL3GamepadCheck : public ClangTidyCheck {
+// ---------------------------------------------------------------------------
+// SDLRenameSummary: the rename sites found in a TU for the checks with the
+// Summary option, grouped by check, file and table row. At the end of the TU
+// each group is reported as one diagnostic at its first site that carries the
+// fixes of all its sites, so a bulk rename costs one diagnostic per file
+// rather than one per site. Removed functions and call rewrites, which need a
+// look at each site, are still reported there.
+// ---------------------------------------------------------------------------
+class SDLRenameSummary {
 public:
-  SDL3GamepadCheck(StringRef Name, ClangTidyContext *Context)
-      : ClangTidyCheck(Name, Context) {}
+  struct Group {
+    ClangTidyCheck *Check;
+    const MigrationEntry *Row;
+    llvm::SmallVector<SourceRange, 4> Sites; // the spellings of Row's name
+  };
+
+  void enable(const ClangTidyCheck &Check, const SourceManager &SM) {
+    Checks.insert(&Check);
+    this->SM = &SM;
+  }
 
-  void registerPPCallbacks(const SourceManager &SM, Preprocessor *PP,
-                           Preprocessor *ModuleExpanderPP) override {
-    PP->addPPCallbacks(::std::make_unique<SDLIncludeCallback>(*this, SM));
+  // Records the rename of Row at Site; false when Check reports it per site
+  bool add(ClangTidyCheck &Check, SourceRange Site, const MigrationEntry &Row) {
+    if (Row.Kind == MigrationKind::RemovedFunction || !Checks.count(&Check))
+      return false;
+    FileID File = SM->getFileID(SM->getFileLoc(Site.getBegin()));
+    auto [It, Inserted] =
+        Index.try_emplace(std::make_tuple(&Check, File, &Row), Groups.size());
+    if (Inserted)
+      Groups.push_back({&Check, &Row, {}});
+    Groups[It->second].Sites.push_back(Site);
+    return true;
   }
 
-  void registerMatchers(ast_matchers::MatchFinder *Finder) override {
+  // In the order of their first sites
+  ArrayRef<Group> groups() const { return Groups; }
 
-    Finder->addMatcher(varDecl(hasType(asString("SDL_GameController *")))
-                           .bind("sdl_game_controller_var"),
-                       this);
-    for (const auto &R : GamepadFuncRenames)
-      Finder->addMatcher(
-          callExpr(callee(functionDecl(hasName(R[0])))).bind(R[0]), this);
+  void clear() {
+    Groups.clear();
+    Index.clear();
+  }
 
-    for (const auto &Removed : GamepadRemovedFuncs)
-      Finder->addMatcher(
-          callExpr(callee(functionDecl(hasName(Removed)))).bind(Removed), this);
+private:
+  llvm::SmallPtrSet<const ClangTidyCheck *, 4> Checks;
+  const SourceManager *SM = nullptr;
+  std::vector<Group> Groups;
+  llvm::DenseMap<std::tuple<ClangTidyCheck *, FileID, const MigrationEntry *>,
+                 size_t>
+      Index;
+};
 
-    for (const auto &S : GamepadSymbolRenames)
-      Finder->addMatcher(declRefExpr(to(namedDecl(hasName(S[0])))).bind(S[0]),
-                         this);
-  }
+// ---------------------------------------------------------------------------
+// SDLProjectHeaders: analyzes each project header once across TUs, with the
+// HeaderCache option (a directory). A project header is any header outside
+// the system and SDL2 directories. Its record holds the findings the checks
+// reported in it, with their fixes, as offsets into the header; it is stored
+// under the hash of the header's contents and of the subscribed checks and
+// their options. The first TU to reach a header without a record analyzes it
+// and writes one at its end. Later TUs, in this process or any other sharing
+// the directory, skip its nodes and drop the findings located in it; with
+// the ReplayHeaders option they report the recorded findings instead, so each
+// TU's output stays complete without analyzing the header again.
+// ---------------------------------------------------------------------------
+struct HeaderFinding {
+  struct Fix {
+    int64_t Offset, Length; // of the replaced text; 0 for an insertion
+    std::string Text;
+
+    bool operator==(const Fix &O) const {
+      return std::tie(Offset, Length, Text) ==
+             std::tie(O.Offset, O.Length, O.Text);
+    }
+  };
 
-  void check(const ast_matchers::MatchFinder::MatchResult &Result) override {
-    if (const auto *Var =
-            Result.Nodes.getNodeAs<VarDecl>("sdl_game_controller_var")) {
-      diag(Var->getLocation(),
-           "SDL_GameController has been renamed to SDL_Gamepad in SDL3")
-          << FixItHint::CreateReplacement(
-                 Var->getTypeSourceInfo()->getTypeLoc().getSourceRange(),
-                 "SDL_Gamepad *");
-    }
-    for (const auto &R : GamepadFuncRenames) {
-      if (const auto *Call = Result.Nodes.getNodeAs<CallExpr>(R[0])) {
-        diag(Call->getBeginLoc(), "%0() has been renamed to %1() in SDL3")
-            << R[0] << R[1]
-            << FixItHint::CreateReplacement(Call->getCallee()->getSourceRange(),
-                                            R[1]);
-        return;
-      }
-    }
-    for (const auto &Removed : GamepadRemovedFuncs) {
-      if (const auto *Call = Result.Nodes.getNodeAs<CallExpr>(Removed)) {
-        diag(Call->getBeginLoc(), "%0() has been removed in SDL3") << Removed;
-        return;
-      }
-    }
-    for (const auto &S : GamepadSymbolRenames) {
-      if (const auto *DRE = Result.Nodes.getNodeAs<DeclRefExpr>(S[0])) {
-        diag(DRE->getBeginLoc(), "%0 has been renamed to %1 in SDL3")
-            << S[0] << S[1]
-            << FixItHint::CreateReplacement(DRE->getSourceRange(), S[1]);
-        return;
-      }
-    }
+  std::string Check;
+  int64_t Offset;
+  std::string Message; // the format given to diag()
+  std::vector<std::string> Args;
+  std::vector<Fix> Fixes;
+
+  bool operator==(const HeaderFinding &O) const {
+    return std::tie(Check, Offset, Message, Args, Fixes) ==
+           std::tie(O.Check, O.Offset, O.Message, O.Args, O.Fixes);
   }
 };
 
-// ===========================================================================
-// SDL3JoystickCheck  (SDL_joystick.h)
-// ===========================================================================
-static const char *JoystickFuncRenames[][2] = {
-    {"SDL_JoystickAttachVirtualEx", "SDL_AttachVirtualJoystick"},
-    {"SDL_JoystickClose", "SDL_CloseJoystick"},
-    {"SDL_JoystickDetachVirtual", "SDL_DetachVirtualJoystick"},
-    {"SDL_JoystickFromInstanceID", "SDL_GetJoystickFromID"},
-    {"SDL_JoystickFromPlayerIndex", "SDL_GetJoystickFromPlayerIndex"},
-    {"SDL_JoystickGetAttached", "SDL_JoystickConnected"},
-    {"SDL_JoystickGetAxis", "SDL_GetJoystickAxis"},
-    {"SDL_JoystickGetAxisInitialState", "SDL_GetJoystickAxisInitialState"},
-    {"SDL_JoystickGetBall", "SDL_GetJoystickBall"},
-    {"SDL_JoystickGetButton", "SDL_GetJoystickButton"},
-    {"SDL_JoystickGetFirmwareVersion", "SDL_GetJoystickFirmwareVersion"},
-    {"SDL_JoystickGetGUID", "SDL_GetJoystickGUID"},
-    {"SDL_JoystickGetGUIDFromString", "SDL_StringToGUID"},
-    {"SDL_JoystickGetHat", "SDL_GetJoystickHat"},
-    {"SDL_JoystickGetPlayerIndex", "SDL_GetJoystickPlayerIndex"},
-    {"SDL_JoystickGetProduct", "SDL_GetJoystickProduct"},
-    {"SDL_JoystickGetProductVersion", "SDL_GetJoystickProductVersion"},
-    {"SDL_JoystickGetSerial", "SDL_GetJoystickSerial"},
-    {"SDL_JoystickGetType", "SDL_GetJoystickType"},
-    {"SDL_JoystickGetVendor", "SDL_GetJoystickVendor"},
-    {"SDL_JoystickInstanceID", "SDL_GetJoystickID"},
-    {"SDL_JoystickIsVirtual", "SDL_IsJoystickVirtual"},
-    {"SDL_JoystickName", "SDL_GetJoystickName"},
-    {"SDL_JoystickNumAxes", "SDL_GetNumJoystickAxes"},
-    {"SDL_JoystickNumBalls", "SDL_GetNumJoystickBalls"},
-    {"SDL_JoystickNumButtons", "SDL_GetNumJoystickButtons"},
-    {"SDL_JoystickNumHats", "SDL_GetNumJoystickHats"},
-    {"SDL_JoystickOpen", "SDL_OpenJoystick"},
-    {"SDL_JoystickPath", "SDL_GetJoystickPath"},
-    {"SDL_JoystickRumble", "SDL_RumbleJoystick"},
-    {"SDL_JoystickRumbleTriggers", "SDL_RumbleJoystickTriggers"},
-    {"SDL_JoystickSendEffect", "SDL_SendJoystickEffect"},
-    {"SDL_JoystickSetLED", "SDL_SetJoystickLED"},
-    {"SDL_JoystickSetPlayerIndex", "SDL_SetJoystickPlayerIndex"},
-    {"SDL_JoystickSetVirtualAxis", "SDL_SetJoystickVirtualAxis"},
-    {"SDL_JoystickSetVirtualButton", "SDL_SetJoystickVirtualButton"},
-    {"SDL_JoystickSetVirtualHat", "SDL_SetJoystickVirtualHat"},
-    {"SDL_JoystickUpdate", "SDL_UpdateJoysticks"},
-};
+using HeaderRecord = std::vector<HeaderFinding>;
 
-static const char *JoystickRemovedFuncs[] = {
-    "SDL_JoystickAttachVirtual",
-    "SDL_JoystickCurrentPowerLevel",
-    "SDL_JoystickEventState",
-    "SDL_JoystickGetDeviceGUID",
-    "SDL_JoystickGetDeviceInstanceID",
-    "SDL_JoystickGetDevicePlayerIndex",
-    "SDL_JoystickGetDeviceProduct",
-    "SDL_JoystickGetDeviceProductVersion",
-    "SDL_JoystickGetDeviceType",
-    "SDL_JoystickGetDeviceVendor",
-    "SDL_JoystickGetGUIDString",
-    "SDL_JoystickHasLED",
-    "SDL_JoystickHasRumble",
-    "SDL_JoystickHasRumbleTriggers",
-    "SDL_JoystickNameForIndex",
-    "SDL_JoystickPathForIndex",
-    "SDL_NumJoysticks",
-};
+static bool fromJSON(const llvm::json::Value &Value, HeaderFinding::Fix &Fix,
+                     llvm::json::Path Path) {
+  llvm::json::ObjectMapper Object(Value, Path);
+  return Object && Object.map("offset", Fix.Offset) &&
+         Object.map("length", Fix.Length) && Object.map("text", Fix.Text);
+}
 
-static const char *JoystickSymbolRenames[][2] = {
-    {"SDL_JOYSTICK_TYPE_GAMECONTROLLER", "SDL_JOYSTICK_TYPE_GAMEPAD"},
-};
+static bool fromJSON(const llvm::json::Value &Value, HeaderFinding &Finding,
+                     llvm::json::Path Path) {
+  llvm::json::ObjectMapper Object(Value, Path);
+  return Object && Object.map("check", Finding.Check) &&
+         Object.map("offset", Finding.Offset) &&
+         Object.map("message", Finding.Message) &&
+         Object.map("args", Finding.Args) && Object.map("fixes", Finding.Fixes);
+}
 
-class SDL3JoystickCheck : public ClangTidyCheck {
+// The records of a HeaderCache directory, read once per process and shared by
+// its TUs and threads
+class SDLHeaderRecordStore {
 public:
-  SDL3JoystickCheck(StringRef Name, ClangTidyContext *Context)
-      : ClangTidyCheck(Name, Context) {}
-
-  void registerPPCallbacks(const SourceManager &SM, Preprocessor *PP,
-                           Preprocessor *ModuleExpanderPP) override {
-    PP->addPPCallbacks(::std::make_unique<SDLIncludeCallback>(*this, SM));
-  }
-
-  void registerMatchers(ast_matchers::MatchFinder *Finder) override {
-    for (const auto &R : JoystickFuncRenames)
-      Finder->addMatcher(
-          callExpr(callee(functionDecl(hasName(R[0])))).bind(R[0]), this);
-
-    for (const auto &Removed : JoystickRemovedFuncs)
-      Finder->addMatcher(
-          callExpr(callee(functionDecl(hasName(Removed)))).bind(Removed), this);
-
-    for (const auto &S : JoystickSymbolRenames)
-      Finder->addMatcher(declRefExpr(to(namedDecl(hasName(S[0])))).bind(S[0]),
-                         this);
+  // The record of Key, or null if there is none (or it is unreadable)
+  static std::shared_ptr<const HeaderRecord> find(StringRef Directory,
+                                                  StringRef Key) {
+    std::string Path = pathOf(Directory, Key);
+    {
+      std::lock_guard<std::mutex> Guard(Lock);
+      auto It = Records.find(Path);
+      if (It != Records.end())
+        return It->second;
+    }
+    auto Buffer = llvm::MemoryBuffer::getFile(Path);
+    if (!Buffer)
+      return nullptr;
+    llvm::Expected<llvm::json::Value> JSON =
+        llvm::json::parse((*Buffer)->getBuffer());
+    if (!JSON) {
+      llvm::consumeError(JSON.takeError());
+      return nullptr;
+    }
+    auto Record = std::make_shared<HeaderRecord>();
+    llvm::json::Path::Root Root;
+    if (!fromJSON(*JSON, *Record, Root))
+      return nullptr;
+    std::lock_guard<std::mutex> Guard(Lock);
+    return Records.try_emplace(Path, std::move(Record)).first->second;
   }
 
-  void check(const ast_matchers::MatchFinder::MatchResult &Result) override {
-    for (const auto &R : JoystickFuncRenames) {
-      if (const auto *Call = Result.Nodes.getNodeAs<CallExpr>(R[0])) {
-        diag(Call->getBeginLoc(), "%0() has been renamed to %1() in SDL3")
-            << R[0] << R[1]
-            << FixItHint::CreateReplacement(Call->getCallee()->getSourceRange(),
-                                            R[1]);
-        return;
-      }
+  // Writes the record of Key; a concurrent writer of the same key writes the
+  // same record, so the last rename wins harmlessly
+  static void store(StringRef Directory, StringRef Key, HeaderRecord Record) {
+    std::string Path = pathOf(Directory, Key);
+    int FD = -1;
+    llvm::SmallString<256> Temporary;
+    std::error_code EC = llvm::sys::fs::create_directories(Directory);
+    if (!EC)
+      EC = llvm::sys::fs::createUniqueFile(Path + "-%%%%%%.tmp", FD,
+                                           Temporary);
+    if (EC) {
+      llvm::errs() << "cannot write header record to '" << Directory
+                   << "': " << EC.message() << "\n";
+      return;
     }
-    for (const auto &Removed : JoystickRemovedFuncs) {
-      if (const auto *Call = Result.Nodes.getNodeAs<CallExpr>(Removed)) {
-        diag(Call->getBeginLoc(), "%0() has been removed in SDL3") << Removed;
-        return;
-      }
+    {
+      llvm::raw_fd_ostream OS(FD, /*shouldClose=*/true);
+      llvm::json::OStream JSON(OS);
+      JSON.array([&] {
+        for (const HeaderFinding &Finding : Record)
+          JSON.object([&] {
+            JSON.attribute("check", Finding.Check);
+            JSON.attribute("offset", Finding.Offset);
+            JSON.attribute("message", Finding.Message);
+            JSON.attributeArray("args", [&] {
+              for (const std::string &Arg : Finding.Args)
+                JSON.value(Arg);
+            });
+            JSON.attributeArray("fixes", [&] {
+              for (const HeaderFinding::Fix &Fix : Finding.Fixes)
+                JSON.object([&] {
+                  JSON.attribute("offset", Fix.Offset);
+                  JSON.attribute("length", Fix.Length);
+                  JSON.attribute("text", Fix.Text);
+                });
+            });
+          });
+      });
     }
-    for (const auto &S : JoystickSymbolRenames) {
-      if (const auto *DRE = Result.Nodes.getNodeAs<DeclRefExpr>(S[0])) {
-        diag(DRE->getBeginLoc(), "%0 has been renamed to %1 in SDL3")
-            << S[0] << S[1]
-            << FixItHint::CreateReplacement(DRE->getSourceRange(), S[1]);
-        return;
-      }
+    if (llvm::sys::fs::rename(Temporary, Path)) {
+      llvm::sys::fs::remove(Temporary);
+      return;
     }
+    std::lock_guard<std::mutex> Guard(Lock);
+    Records[Path] = std::make_shared<HeaderRecord>(std::move(Record));
   }
-};
 
-// ===========================================================================
-// SDL3HapticCheck  (SDL_haptic.h)
-// ===========================================================================
-static const char *HapticFuncRenames[][2] = {
-    {"SDL_HapticClose", "SDL_CloseHaptic"},
-    {"SDL_HapticDestroyEffect", "SDL_DestroyHapticEffect"},
-    {"SDL_HapticGetEffectStatus", "SDL_GetHapticEffectStatus"},
-    {"SDL_HapticNewEffect", "SDL_CreateHapticEffect"},
-    {"SDL_HapticNumAxes", "SDL_GetNumHapticAxes"},
-    {"SDL_HapticNumEffects", "SDL_GetMaxHapticEffects"},
-    {"SDL_HapticNumEffectsPlaying", "SDL_GetMaxHapticEffectsPlaying"},
-    {"SDL_HapticOpen", "SDL_OpenHaptic"},
-    {"SDL_HapticOpenFromJoystick", "SDL_OpenHapticFromJoystick"},
-    {"SDL_HapticOpenFromMouse", "SDL_OpenHapticFromMouse"},
-    {"SDL_HapticPause", "SDL_PauseHaptic"},
-    {"SDL_HapticQuery", "SDL_GetHapticFeatures"},
-    {"SDL_HapticRumbleInit", "SDL_InitHapticRumble"},
-    {"SDL_HapticRumblePlay", "SDL_PlayHapticRumble"},
-    {"SDL_HapticRumbleStop", "SDL_StopHapticRumble"},
-    {"SDL_HapticRunEffect", "SDL_RunHapticEffect"},
-    {"SDL_HapticSetAutocenter", "SDL_SetHapticAutocenter"},
-    {"SDL_HapticSetGain", "SDL_SetHapticGain"},
-    {"SDL_HapticStopAll", "SDL_StopHapticEffects"},
-    {"SDL_HapticStopEffect", "SDL_StopHapticEffect"},
-    {"SDL_HapticUnpause", "SDL_ResumeHaptic"},
-    {"SDL_HapticUpdateEffect", "SDL_UpdateHapticEffect"},
-    {"SDL_JoystickIsHaptic", "SDL_IsJoystickHaptic"},
-    {"SDL_MouseIsHaptic", "SDL_IsMouseHaptic"},
-};
+private:
+  static std::string pathOf(StringRef Directory, StringRef Key) {
+    llvm::SmallString<256> Path(Directory);
+    llvm::sys::path::append(Path, Key + ".json");
+    return std::string(Path);
+  }
 
-static const char *HapticRemovedFuncs[] = {
-    "SDL_HapticIndex",
-    "SDL_HapticName",
-    "SDL_HapticOpened",
-    "SDL_NumHaptics",
+  static inline std::mutex Lock;
+  static inline llvm::StringMap<std::shared_ptr<const HeaderRecord>> Records;
 };
 
-class SDL3HapticCheck : public ClangTidyCheck {
+class SDLProjectHeaders {
 public:
-  SDL3HapticCheck(StringRef Name, ClangTidyContext *Context)
-      : ClangTidyCheck(Name, Context) {}
+  struct Header {
+    FileID FID;
+    std::string Key;
+    std::shared_ptr<const HeaderRecord> Cached; // null: analyzed in this TU
+    HeaderRecord Found;     // what the checks reported in it, if analyzed
+    bool Recordable = true; // false once a finding could not be recorded
+  };
+
+  // Directory: where the records live; the first subscriber with one decides
+  void enable(StringRef Directory, bool Replay, const SourceManager &SM,
+              const LangOptions &LangOpts) {
+    if (!enabled() && !Directory.empty()) {
+      this->Directory = Directory.str();
+      this->Replay = Replay;
+      this->SM = &SM;
+      this->LangOpts = &LangOpts;
+    }
+  }
+  bool enabled() const { return !Directory.empty(); }
 
-  void registerPPCallbacks(const SourceManager &SM, Preprocessor *PP,
-                           Preprocessor *ModuleExpanderPP) override {
-    PP->addPPCallbacks(::std::make_unique<SDLIncludeCallback>(*this, SM));
+  // Adds a check's name and the options its findings depend on to what the
+  // records are keyed by; every subscriber adds its own
+  void configure(StringRef Fingerprint) {
+    Config += Fingerprint;
+    Config += ';';
   }
 
-  void registerMatchers(ast_matchers::MatchFinder *Finder) override {
-    for (const auto &R : HapticFuncRenames)
-      Finder->addMatcher(
-          callExpr(callee(functionDecl(hasName(R[0])))).bind(R[0]), this);
+  // Called as the preprocessor enters FID
+  void enterFile(const SourceManager &SM, FileID FID,
+                 SrcMgr::CharacteristicKind FileType) {
+    if (!enabled() || FileType != SrcMgr::C_User ||
+        FID == SM.getMainFileID() || Headers.count(FID))
+      return;
+    OptionalFileEntryRef File = SM.getFileEntryRefForID(FID);
+    if (!File || IsSDL2Header(*File))
+      return;
+    if (ConfigHash.empty())
+      ConfigHash = hex(llvm::xxh3_64bits(llvm::arrayRefFromStringRef(Config)));
+    Header &H = Headers[FID];
+    H.FID = FID;
+    H.Key = hex(llvm::xxh3_64bits(
+                llvm::arrayRefFromStringRef(SM.getBufferData(FID)))) +
+            "-" + ConfigHash;
+    H.Cached = SDLHeaderRecordStore::find(Directory, H.Key);
+  }
 
-    for (const auto &Removed : HapticRemovedFuncs)
-      Finder->addMatcher(
-          callExpr(callee(functionDecl(hasName(Removed)))).bind(Removed), this);
+  // The project header FID, if it is one
+  Header *find(FileID FID) {
+    if (Headers.empty())
+      return nullptr;
+    auto It = Headers.find(FID);
+    return It == Headers.end() ? nullptr : &It->second;
   }
 
-  void check(const ast_matchers::MatchFinder::MatchResult &Result) override {
-    for (const auto &R : HapticFuncRenames) {
-      if (const auto *Call = Result.Nodes.getNodeAs<CallExpr>(R[0])) {
-        diag(Call->getBeginLoc(), "%0() has been renamed to %1() in SDL3")
-            << R[0] << R[1]
-            << FixItHint::CreateReplacement(Call->getCallee()->getSourceRange(),
-                                            R[1]);
-        return;
-      }
+  bool isCached(FileID FID) {
+    Header *H = find(FID);
+    return H && H->Cached;
+  }
+
+  // Analyzes the project header holding Loc, a macro definition, in every TU
+  // and never records it: a name with a row in a macro body is only found
+  // where an includer expands the macro, so what the checks find in the
+  // header depends on the TU. Matching starts after preprocessing, so
+  // dropping a record here still analyzes the whole header.
+  void keepUncached(SourceLocation Loc) {
+    if (!enabled())
+      return;
+    if (Header *H = find(SM->getFileID(Loc))) {
+      H->Cached.reset();
+      H->Recordable = false;
     }
-    for (const auto &Removed : HapticRemovedFuncs) {
-      if (const auto *Call = Result.Nodes.getNodeAs<CallExpr>(Removed)) {
-        diag(Call->getBeginLoc(), "%0() has been removed in SDL3") << Removed;
-        return;
+  }
+
+  // The project header a diagnostic at Loc is reported in, if any, and the
+  // offset of Loc in it
+  Header *headerAt(SourceLocation Loc, int64_t &Offset) {
+    if (Headers.empty() || Loc.isInvalid())
+      return nullptr;
+    auto [FID, FileOffset] = SM->getDecomposedLoc(SM->getFileLoc(Loc));
+    Offset = FileOffset;
+    return find(FID);
+  }
+
+  // Appends Hint to Fixes as offsets into H; false if it reaches out of H
+  bool addFix(const Header &H, const FixItHint &Hint,
+              std::vector<HeaderFinding::Fix> &Fixes) const {
+    CharSourceRange Range =
+        Lexer::makeFileCharRange(Hint.RemoveRange, *SM, *LangOpts);
+    if (Range.isInvalid() || Hint.InsertFromRange.isValid())
+      return false;
+    auto [BeginFID, Begin] = SM->getDecomposedLoc(Range.getBegin());
+    auto [EndFID, End] = SM->getDecomposedLoc(Range.getEnd());
+    if (BeginFID != H.FID || EndFID != H.FID)
+      return false;
+    Fixes.push_back({Begin, End - Begin, Hint.CodeToInsert});
+    return true;
+  }
+
+  // Writes the records of the headers analyzed in the TU, unless Failed (the
+  // TU had errors, so their analysis may be incomplete), and passes the
+  // findings of the others to Replay if the ReplayHeaders option is set
+  void finish(bool Failed,
+              llvm::function_ref<void(FileID, const HeaderFinding &)> Replay) {
+    llvm::StringMap<std::pair<HeaderRecord, bool>> Analyzed;
+    for (auto &[FID, H] : Headers) {
+      if (H.Cached) {
+        if (this->Replay)
+          for (const HeaderFinding &Finding : *H.Cached)
+            Replay(FID, Finding);
+        continue;
       }
+      // A header entered twice (no include guard) is analyzed twice
+      auto &[Record, Recordable] =
+          Analyzed.try_emplace(H.Key, HeaderRecord(), true).first->second;
+      Recordable &= H.Recordable;
+      for (HeaderFinding &Finding : H.Found)
+        if (!llvm::is_contained(Record, Finding))
+          Record.push_back(std::move(Finding));
     }
+    if (!Failed)
+      for (auto &Entry : Analyzed)
+        if (Entry.second.second)
+          SDLHeaderRecordStore::store(Directory, Entry.first(),
+                                      std::move(Entry.second.first));
+    Headers.clear();
   }
-};
-
-// ===========================================================================
-// SDL3MouseCheck  (SDL_mouse.h)
-// ===========================================================================
-static const char *MouseFuncRenames[][2] = {
-    {"SDL_FreeCursor", "SDL_DestroyCursor"},
-};
 
-static const char *MouseRemovedFuncs[] = {
-    "SDL_SetRelativeMouseMode",
-    "SDL_GetRelativeMouseMode",
-};
+private:
+  static std::string hex(uint64_t Hash) {
+    std::string Text;
+    llvm::raw_string_ostream(Text) << llvm::format_hex_no_prefix(Hash, 16);
+    return Text;
+  }
 
-static const char *MouseSymbolRenames[][2] = {
-    {"SDL_BUTTON", "SDL_BUTTON_MASK"},
-    {"SDL_NUM_SYSTEM_CURSORS", "SDL_SYSTEM_CURSOR_COUNT"},
-    {"SDL_SYSTEM_CURSOR_ARROW", "SDL_SYSTEM_CURSOR_DEFAULT"},
-    {"SDL_SYSTEM_CURSOR_HAND", "SDL_SYSTEM_CURSOR_POINTER"},
-    {"SDL_SYSTEM_CURSOR_IBEAM", "SDL_SYSTEM_CURSOR_TEXT"},
-    {"SDL_SYSTEM_CURSOR_NO", "SDL_SYSTEM_CURSOR_NOT_ALLOWED"},
-    {"SDL_SYSTEM_CURSOR_SIZEALL", "SDL_SYSTEM_CURSOR_MOVE"},
-    {"SDL_SYSTEM_CURSOR_SIZENESW", "SDL_SYSTEM_CURSOR_NESW_RESIZE"},
-    {"SDL_SYSTEM_CURSOR_SIZENS", "SDL_SYSTEM_CURSOR_NS_RESIZE"},
-    {"SDL_SYSTEM_CURSOR_SIZENWSE", "SDL_SYSTEM_CURSOR_NWSE_RESIZE"},
-    {"SDL_SYSTEM_CURSOR_SIZEWE", "SDL_SYSTEM_CURSOR_EW_RESIZE"},
-    {"SDL_SYSTEM_CURSOR_WAITARROW", "SDL_SYSTEM_CURSOR_PROGRESS"},
+  std::string Directory;
+  bool Replay = false;
+  const SourceManager *SM = nullptr;
+  const LangOptions *LangOpts = nullptr;
+  std::string Config;
+  std::string ConfigHash;
+  llvm::DenseMap<FileID, Header> Headers;
 };
 
-class SDL3MouseCheck : public ClangTidyCheck {
+// ---------------------------------------------------------------------------
+// SDLMacroDefinitions: the names with a migration table row spelled in the
+// bodies of the TU's own macros, e.g. SDL_RenderCopy in
+//   #define DRAW(r, t) SDL_RenderCopy(r, t, NULL, NULL)
+// SDLIncludeMigrator notes them as the macros are defined. The AST paths meet
+// such a name at every expansion of the macro; the first match that finds it
+// refers to an SDL2 decl with a row defers the row to the end of the TU,
+// where it is reported once, with its fix in the definition, and the later
+// ones only find it deferred already. A macro the TU never expands is left
+// alone, as nothing shows that its names are SDL2's. As the fix depends on
+// the expansions of the TU, a project header defining such a macro is kept
+// out of the HeaderCache (SDLProjectHeaders::keepUncached), so a record of a
+// TU that did not expand the macro never drops it.
+// ---------------------------------------------------------------------------
+class SDLMacroDefinitions {
 public:
-  SDL3MouseCheck(StringRef Name, ClangTidyContext *Context)
-      : ClangTidyCheck(Name, Context) {}
-
-  void registerPPCallbacks(const SourceManager &SM, Preprocessor *PP,
-                           Preprocessor *ModuleExpanderPP) override {
-    PP->addPPCallbacks(::std::make_unique<SDLIncludeCallback>(*this, SM));
+  struct Site {
+    ClangTidyCheck *Check;
+    SourceLocation Loc; // of the name, in the macro's definition
+    const MigrationEntry *Row;
+  };
+
+  // Notes Loc, the spelling of a name with a row in a macro body
+  void addName(const SourceManager &SM, SourceLocation Loc) {
+    this->SM = &SM;
+    Names.insert(Loc);
   }
 
-  void registerMatchers(ast_matchers::MatchFinder *Finder) override {
-    for (const auto &R : MouseFuncRenames)
-      Finder->addMatcher(
-          callExpr(callee(functionDecl(hasName(R[0])))).bind(R[0]), this);
+  // Defers Row, matched at Range, if Range is the expansion of a name noted
+  // in a macro body; false otherwise
+  bool defer(ClangTidyCheck &Check, SourceRange Range,
+             const MigrationEntry &Row) {
+    if (Names.empty() || !Range.getBegin().isMacroID())
+      return false;
+    SourceLocation Loc = SM->getSpellingLoc(Range.getBegin());
+    if (!Names.count(Loc))
+      return false;
+    if (Deferred.insert({Loc, &Check}).second)
+      Sites.push_back({&Check, Loc, &Row});
+    return true;
+  }
 
-    for (const auto &Removed : MouseRemovedFuncs)
-      Finder->addMatcher(
-          callExpr(callee(functionDecl(hasName(Removed)))).bind(Removed), this);
+  // In the order they were first matched
+  ArrayRef<Site> sites() const { return Sites; }
 
-    for (const auto &S : MouseSymbolRenames)
-      Finder->addMatcher(declRefExpr(to(namedDecl(hasName(S[0])))).bind(S[0]),
-                         this);
+  void clear() {
+    Sites.clear();
+    Deferred.clear();
   }
 
-  void check(const ast_matchers::MatchFinder::MatchResult &Result) override {
-    for (const auto &R : MouseFuncRenames) {
-      if (const auto *Call = Result.Nodes.getNodeAs<CallExpr>(R[0])) {
-        diag(Call->getBeginLoc(), "%0() has been renamed to %1() in SDL3")
-            << R[0] << R[1]
-            << FixItHint::CreateReplacement(Call->getCallee()->getSourceRange(),
-                                            R[1]);
-        return;
-      }
-    }
-    for (const auto &Removed : MouseRemovedFuncs) {
-      if (const auto *Call = Result.Nodes.getNodeAs<CallExpr>(Removed)) {
-        if (StringRef(Removed) == "SDL_SetRelativeMouseMode") {
-          diag(Call->getBeginLoc(),
-               "SDL_SetRelativeMouseMode() has been removed; "
-               "use SDL_SetWindowRelativeMouseMode() instead");
-        } else if (StringRef(Removed) == "SDL_GetRelativeMouseMode") {
-          diag(Call->getBeginLoc(),
-               "SDL_GetRelativeMouseMode() has been removed; "
-               "use SDL_GetWindowRelativeMouseMode() instead");
-        } else {
-          diag(Call->getBeginLoc(), "%0() has been removed in SDL3") << Removed;
-        }
-        return;
-      }
-    }
-    for (const auto &S : MouseSymbolRenames) {
-      if (const auto *DRE = Result.Nodes.getNodeAs<DeclRefExpr>(S[0])) {
-        diag(DRE->getBeginLoc(), "%0 has been renamed to %1 in SDL3")
-            << S[0] << S[1]
-            << FixItHint::CreateReplacement(DRE->getSourceRange(), S[1]);
-        return;
-      }
-    }
-  }
+private:
+  const SourceManager *SM = nullptr;
+  llvm::DenseSet<SourceLocation> Names;
+  llvm::DenseSet<std::pair<SourceLocation, const ClangTidyCheck *>> Deferred;
+  std::vector<Site> Sites;
 };
 
-// ===========================================================================
-// SDL3RenderCheck  (SDL_render.h)
-// ===========================================================================
-static const char *RenderFuncRenames[][2] = {
-    {"SDL_GetRendererOutputSize", "SDL_GetCurrentRenderOutputSize"},
-    {"SDL_RenderCopy", "SDL_RenderTexture"},
-    {"SDL_RenderCopyEx", "SDL_RenderTextureRotated"},
-    {"SDL_RenderCopyExF", "SDL_RenderTextureRotated"},
-    {"SDL_RenderCopyF", "SDL_RenderTexture"},
-    {"SDL_RenderDrawLine", "SDL_RenderLine"},
-    {"SDL_RenderDrawLineF", "SDL_RenderLine"},
-    {"SDL_RenderDrawLines", "SDL_RenderLines"},
-    {"SDL_RenderDrawLinesF", "SDL_RenderLines"},
-    {"SDL_RenderDrawPoint", "SDL_RenderPoint"},
-    {"SDL_RenderDrawPointF", "SDL_RenderPoint"},
-    {"SDL_RenderDrawPoints", "SDL_RenderPoints"},
-    {"SDL_RenderDrawPointsF", "SDL_RenderPoints"},
-    {"SDL_RenderDrawRect", "SDL_RenderRect"},
-    {"SDL_RenderDrawRectF", "SDL_RenderRect"},
-    {"SDL_RenderDrawRects", "SDL_RenderRects"},
-    {"SDL_RenderDrawRectsF", "SDL_RenderRects"},
-    {"SDL_RenderFillRectF", "SDL_RenderFillRect"},
-    {"SDL_RenderFillRectsF", "SDL_RenderFillRects"},
-    {"SDL_RenderFlush", "SDL_FlushRenderer"},
-    {"SDL_RenderGetClipRect", "SDL_GetRenderClipRect"},
-    {"SDL_RenderGetIntegerScale", "SDL_GetRenderIntegerScale"},
-    {"SDL_RenderGetLogicalSize", "SDL_GetRenderLogicalPresentation"},
-    {"SDL_RenderGetMetalCommandEncoder", "SDL_GetRenderMetalCommandEncoder"},
-    {"SDL_RenderGetMetalLayer", "SDL_GetRenderMetalLayer"},
-    {"SDL_RenderGetScale", "SDL_GetRenderScale"},
-    {"SDL_RenderGetViewport", "SDL_GetRenderViewport"},
-    {"SDL_RenderGetWindow", "SDL_GetRenderWindow"},
-    {"SDL_RenderIsClipEnabled", "SDL_RenderClipEnabled"},
-    {"SDL_RenderLogicalToWindow", "SDL_RenderCoordinatesToWindow"},
-    {"SDL_RenderSetClipRect", "SDL_SetRenderClipRect"},
-    {"SDL_RenderSetLogicalSize", "SDL_SetRenderLogicalPresentation"},
-    {"SDL_RenderSetScale", "SDL_SetRenderScale"},
-    {"SDL_RenderSetVSync", "SDL_SetRenderVSync"},
-    {"SDL_RenderSetViewport", "SDL_SetRenderViewport"},
-    {"SDL_RenderWindowToLogical", "SDL_RenderCoordinatesFromWindow"},
+// ---------------------------------------------------------------------------
+// SDLTUState: what the checks know of the TU being processed on this thread:
+// the SDL2 header cache and decl memo every check shares, the checks whose
+// SDL2 headers the TU reaches, the renames held for a summary or for the TU's
+// macro definitions and the project headers analyzed once.
+// SDLIncludeMigrator owns it for the lifetime of the TU. The matchers below
+// are built once per process and shared by every TU and thread (see
+// SDLMatcherSet), so they hold no per-TU state and read it from here instead.
+// ---------------------------------------------------------------------------
+struct SDLTUState {
+  SDLHeaderCache Headers;
+  SDLDeclMemo Memo{Headers};
+  uint32_t Included = 0; // MaskOf() the checks whose SDL2 headers are reached
+  std::unique_ptr<SDLStats> Stats; // with option StatsDirectory
+  SDLRenameSummary Summary;
+  SDLMacroDefinitions MacroDefinitions;
+  // The checks with the ReportOnly option, which build no fixes
+  llvm::SmallPtrSet<const ClangTidyCheck *, 4> ReportOnly;
+  SDLProjectHeaders ProjectHeaders; // with option HeaderCache
+
+  static inline thread_local SDLTUState *Current = nullptr;
 };
 
-static const char *RenderRemovedFuncs[] = {
-    "SDL_GL_BindTexture",        "SDL_GL_UnbindTexture",
-    "SDL_GetTextureUserData",    "SDL_RenderSetIntegerScale",
-    "SDL_RenderTargetSupported", "SDL_SetTextureUserData",
-    "SDL_GetRenderDriverInfo",
-};
+// Helper: the stats of the TU being processed, if it keeps any
+static SDLStats *CurrentStats() {
+  return SDLTUState::Current ? SDLTUState::Current->Stats.get() : nullptr;
+}
 
-static const char *RenderSymbolRenames[][2] = {
-    {"SDL_ScaleModeLinear", "SDL_SCALEMODE_LINEAR"},
-    {"SDL_ScaleModeNearest", "SDL_SCALEMODE_NEAREST"},
-};
+// Helper: whether Check builds fixes in the TU being processed
+static bool BuildsFixes(const ClangTidyCheck &Check) {
+  SDLTUState *TU = SDLTUState::Current;
+  return !TU || !TU->ReportOnly.count(&Check);
+}
 
-class SDL3RenderCheck : public ClangTidyCheck {
-public:
-  SDL3RenderCheck(StringRef Name, ClangTidyContext *Context)
-      : ClangTidyCheck(Name, Context) {}
+// Helper: the rows of D in the TU being matched
+static SDLDeclMemo::Rows RowsOf(const NamedDecl &D, ASTContext &Context) {
+  SDLTUState *TU = SDLTUState::Current;
+  return TU ? TU->Memo.lookup(&D, Context.getSourceManager())
+            : SDLDeclMemo::Rows();
+}
 
-  void registerPPCallbacks(const SourceManager &SM, Preprocessor *PP,
-                           Preprocessor *ModuleExpanderPP) override {
-    PP->addPPCallbacks(::std::make_unique<SDLIncludeCallback>(*this, SM));
-  }
+// Matches decls declared in an SDL2 header
+AST_MATCHER(Decl, isDeclaredInSDLHeader) {
+  SDLTUState *TU = SDLTUState::Current;
+  return TU && TU->Headers.isSDLHeader(
+                   Finder->getASTContext().getSourceManager(),
+                   Node.getLocation());
+}
 
-  void registerMatchers(ast_matchers::MatchFinder *Finder) override {
-    for (const auto &R : RenderFuncRenames)
-      Finder->addMatcher(
-          callExpr(callee(functionDecl(hasName(R[0])))).bind(R[0]), this);
+// Matches type names spelled in an SDL2 header, which declares its own API
+// with them
+AST_MATCHER(TypeLoc, isSpelledInSDLHeader) {
+  SDLTUState *TU = SDLTUState::Current;
+  return TU && TU->Headers.isSDLHeader(
+                   Finder->getASTContext().getSourceManager(),
+                   Node.getBeginLoc());
+}
 
-    for (const auto &Removed : RenderRemovedFuncs)
-      Finder->addMatcher(
-          callExpr(callee(functionDecl(hasName(Removed)))).bind(Removed), this);
+// Matches SDL2 decls with a row in SDLMigrations of a kind in KindMask, owned
+// by a check in CheckMask: one hash lookup per decl, however many names the
+// checks own
+AST_MATCHER_P2(NamedDecl, hasSDLRow, uint32_t, CheckMask, uint32_t,
+               KindMask) {
+  return RowsOf(Node, Finder->getASTContext()).row(CheckMask, KindMask);
+}
 
-    for (const auto &S : RenderSymbolRenames)
-      Finder->addMatcher(declRefExpr(to(namedDecl(hasName(S[0])))).bind(S[0]),
-                         this);
-  }
+// Matches SDL2 functions with a rewrite template owned by a check in CheckMask
+AST_MATCHER_P(NamedDecl, hasSDLCallRewrite, uint32_t, CheckMask) {
+  return RowsOf(Node, Finder->getASTContext()).rewrites(CheckMask);
+}
 
-  void check(const ast_matchers::MatchFinder::MatchResult &Result) override {
-    for (const auto &R : RenderFuncRenames) {
-      if (const auto *Call = Result.Nodes.getNodeAs<CallExpr>(R[0])) {
-        diag(Call->getBeginLoc(), "%0() has been renamed to %1() in SDL3")
-            << R[0] << R[1]
-            << FixItHint::CreateReplacement(Call->getCallee()->getSourceRange(),
-                                            R[1]);
-        return;
-      }
-    }
-    for (const auto &Removed : RenderRemovedFuncs) {
-      if (const auto *Call = Result.Nodes.getNodeAs<CallExpr>(Removed)) {
-        diag(Call->getBeginLoc(), "%0() has been removed in SDL3") << Removed;
-        return;
-      }
-    }
-    for (const auto &S : RenderSymbolRenames) {
-      if (const auto *DRE = Result.Nodes.getNodeAs<DeclRefExpr>(S[0])) {
-        diag(DRE->getBeginLoc(), "%0 has been renamed to %1 in SDL3")
-            << S[0] << S[1]
-            << FixItHint::CreateReplacement(DRE->getSourceRange(), S[1]);
-        return;
-      }
-    }
+// Matches SDL2 functions with a bool row owned by a check in CheckMask
+AST_MATCHER_P(NamedDecl, hasSDLBoolReturn, uint32_t, CheckMask) {
+  return RowsOf(Node, Finder->getASTContext()).boolReturn(CheckMask);
+}
+
+// Helper: visits S and its descendants outside of nested blocks and lambdas
+template <typename Callback>
+static void ForEachOutsideBlocks(const Stmt *S, Callback Visit) {
+  llvm::SmallVector<const Stmt *, 16> Worklist{S};
+  while (!Worklist.empty()) {
+    const Stmt *Next = Worklist.pop_back_val();
+    Visit(Next);
+    for (const Stmt *Child : Next->children())
+      if (Child && !isa<CompoundStmt, LambdaExpr>(Child))
+        Worklist.push_back(Child);
   }
-};
+}
 
-// ===========================================================================
-// SDL3MutexCheck  (SDL_mutex.h)
-// ===========================================================================
-static const char *MutexFuncRenames[][2] = {
-    {"SDL_CondBroadcast", "SDL_BroadcastCondition"},
-    {"SDL_CondSignal", "SDL_SignalCondition"},
-    {"SDL_CondWait", "SDL_WaitCondition"},
-    {"SDL_CondWaitTimeout", "SDL_WaitConditionTimeout"},
-    {"SDL_CreateCond", "SDL_CreateCondition"},
-    {"SDL_DestroyCond", "SDL_DestroyCondition"},
-    {"SDL_SemPost", "SDL_SignalSemaphore"},
-    {"SDL_SemTryWait", "SDL_TryWaitSemaphore"},
-    {"SDL_SemValue", "SDL_GetSemaphoreValue"},
-    {"SDL_SemWait", "SDL_WaitSemaphore"},
-    {"SDL_SemWaitTimeout", "SDL_WaitSemaphoreTimeout"},
-};
+// Matches a statement that contains statements matched by Inner (itself
+// included) outside of nested blocks and lambdas, once for each of them, like
+// forEachDescendant(). Walks down from Node, so unlike hasParent() /
+// hasAncestor() it never makes the ASTContext build its whole-TU parent map.
+AST_MATCHER_P(Stmt, forEachOutsideBlocks,
+              ast_matchers::internal::Matcher<Stmt>, Inner) {
+  ast_matchers::internal::BoundNodesTreeBuilder Matches;
+  bool Matched = false;
+  ForEachOutsideBlocks(&Node, [&](const Stmt *S) {
+    ast_matchers::internal::BoundNodesTreeBuilder Result(*Builder);
+    if (Inner.matches(*S, Finder, &Result)) {
+      Matches.addMatch(Result);
+      Matched = true;
+    }
+  });
+  *Builder = std::move(Matches);
+  return Matched;
+}
 
-static const char *MutexTypeMigrations[][2] = {
-    {"SDL_mutex *", "SDL_Mutex *"},
-    {"SDL_cond *", "SDL_Condition *"},
-    {"SDL_sem *", "SDL_Semaphore *"}};
+// Matches any node once the TU has reached one of the SDL2 headers of a check
+// in CheckMask; SDLIncludeMigrator records them while preprocessing, before
+// any matching starts
+AST_POLYMORPHIC_MATCHER_P(includesCheckedSDLHeader,
+                          AST_POLYMORPHIC_SUPPORTED_TYPES(Decl, Stmt, TypeLoc),
+                          uint32_t, CheckMask) {
+  SDLTUState *TU = SDLTUState::Current;
+  return TU && (TU->Included & CheckMask);
+}
 
-class SDL3MutexCheck : public ClangTidyCheck {
-public:
-  SDL3MutexCheck(StringRef Name, ClangTidyContext *Context)
-      : ClangTidyCheck(Name, Context) {}
+// Matches nodes expanded in a project header whose SDLProjectHeaders record
+// is used in place of analyzing it
+AST_POLYMORPHIC_MATCHER(isExpansionInRecordedHeader,
+                        AST_POLYMORPHIC_SUPPORTED_TYPES(Decl, Stmt, TypeLoc)) {
+  SDLTUState *TU = SDLTUState::Current;
+  if (!TU || !TU->ProjectHeaders.enabled())
+    return false;
+  const SourceManager &SM = Finder->getASTContext().getSourceManager();
+  return TU->ProjectHeaders.isCached(
+      SM.getFileID(SM.getExpansionLoc(Node.getBeginLoc())));
+}
 
-  void registerPPCallbacks(const SourceManager &SM, Preprocessor *PP,
-                           Preprocessor *ModuleExpanderPP) override {
-    PP->addPPCallbacks(::std::make_unique<SDLIncludeCallback>(*this, SM));
-  }
+// ---------------------------------------------------------------------------
+// Helpers to emit the diagnostic (and FixIt) for a migration table row
+// ---------------------------------------------------------------------------
 
-  void registerMatchers(ast_matchers::MatchFinder *Finder) override {
+// Helper: name of a check, through the MatchCallback interface, as
+// ClangTidyCheck does not make getID() public
+static StringRef
+CheckName(const ast_matchers::MatchFinder::MatchCallback &Check) {
+  return Check.getID();
+}
 
-    for (const auto &T : MutexTypeMigrations) {
-      Finder->addMatcher(varDecl(hasType(asString(T[0]))).bind(T[0]), this);
+// A diagnostic of a check, streamed like the DiagnosticBuilder it wraps,
+// through the TU's SDLProjectHeaders: dropped when located in a header whose
+// record is used, and recorded when located in a header analyzed in the TU.
+// The checks report everything through it (see Report() and
+// SDLMigrationCheck::diag()).
+class SDLDiagnostic {
+public:
+  SDLDiagnostic(ClangTidyCheck &Check, SourceLocation Loc, StringRef Message) {
+    SDLTUState *TU = SDLTUState::Current;
+    int64_t Offset = 0;
+    Header = TU ? TU->ProjectHeaders.headerAt(Loc, Offset) : nullptr;
+    if (Header && Header->Cached) {
+      Header = nullptr;
+      return;
     }
+    Builder.emplace(Check.diag(Loc, Message));
+    if (Header) {
+      Headers = &TU->ProjectHeaders;
+      Finding = {CheckName(Check).str(), Offset, Message.str(), {}, {}};
+    }
+  }
+  SDLDiagnostic(const SDLDiagnostic &) = delete;
+  SDLDiagnostic &operator=(const SDLDiagnostic &) = delete;
 
-    for (const auto &R : MutexFuncRenames)
-      Finder->addMatcher(
-          callExpr(callee(functionDecl(hasName(R[0])))).bind(R[0]), this);
+  ~SDLDiagnostic() {
+    if (Header)
+      Header->Found.push_back(std::move(Finding));
   }
 
-  void check(const ast_matchers::MatchFinder::MatchResult &Result) override {
-    for (const auto &R : MutexFuncRenames) {
-      if (const auto *Call = Result.Nodes.getNodeAs<CallExpr>(R[0])) {
-        diag(Call->getBeginLoc(), "%0() has been renamed to %1() in SDL3")
-            << R[0] << R[1]
-            << FixItHint::CreateReplacement(Call->getCallee()->getSourceRange(),
-                                            R[1]);
-        return;
-      }
-    }
+  template <typename T> SDLDiagnostic &operator<<(const T &Value) {
+    if (Builder)
+      *Builder << Value;
+    if (Header)
+      record(Value);
+    return *this;
+  }
 
-    for (const auto &T : MutexTypeMigrations) {
-      if (const auto *Var = Result.Nodes.getNodeAs<VarDecl>(T[0])) {
-        diag(Var->getLocation(),
-             std::string(T[0]) + " has been renamed to " + T[1] + " in SDL3")
-            << FixItHint::CreateReplacement(
-                   Var->getTypeSourceInfo()->getTypeLoc().getSourceRange(),
-                   T[1]);
-        return;
-      }
-    }
+private:
+  void record(StringRef Arg) { Finding.Args.push_back(Arg.str()); }
+  void record(unsigned Arg) { Finding.Args.push_back(std::to_string(Arg)); }
+  void record(const FixItHint &Hint) {
+    if (!Headers->addFix(*Header, Hint, Finding.Fixes))
+      Header->Recordable = false;
   }
-};
 
-// ===========================================================================
-// SDL3RectCheck  (SDL_rect.h)
-// ===========================================================================
-static const char *RectFuncRenames[][2] = {
-    {"SDL_EncloseFPoints", "SDL_GetRectEnclosingPointsFloat"},
-    {"SDL_EnclosePoints", "SDL_GetRectEnclosingPoints"},
-    {"SDL_FRectEmpty", "SDL_RectEmptyFloat"},
-    {"SDL_FRectEquals", "SDL_RectsEqualFloat"},
-    {"SDL_FRectEqualsEpsilon", "SDL_RectsEqualEpsilon"},
-    {"SDL_HasIntersection", "SDL_HasRectIntersection"},
-    {"SDL_HasIntersectionF", "SDL_HasRectIntersectionFloat"},
-    {"SDL_IntersectFRect", "SDL_GetRectIntersectionFloat"},
-    {"SDL_IntersectFRectAndLine", "SDL_GetRectAndLineIntersectionFloat"},
-    {"SDL_IntersectRect", "SDL_GetRectIntersection"},
-    {"SDL_IntersectRectAndLine", "SDL_GetRectAndLineIntersection"},
-    {"SDL_PointInFRect", "SDL_PointInRectFloat"},
-    {"SDL_RectEquals", "SDL_RectsEqual"},
-    {"SDL_UnionFRect", "SDL_GetRectUnionFloat"},
-    {"SDL_UnionRect", "SDL_GetRectUnion"},
+  std::optional<DiagnosticBuilder> Builder; // unset when dropped
+  SDLProjectHeaders *Headers = nullptr;
+  SDLProjectHeaders::Header *Header = nullptr; // set when recording
+  HeaderFinding Finding;
 };
 
-class SDL3RectCheck : public ClangTidyCheck {
-public:
-  SDL3RectCheck(StringRef Name, ClangTidyContext *Context)
-      : ClangTidyCheck(Name, Context) {}
+// Helper: Check.diag(), through the TU's SDLProjectHeaders
+static SDLDiagnostic Report(ClangTidyCheck &Check, SourceLocation Loc,
+                            StringRef Message) {
+  return SDLDiagnostic(Check, Loc, Message);
+}
 
-  void registerPPCallbacks(const SourceManager &SM, Preprocessor *PP,
-                           Preprocessor *ModuleExpanderPP) override {
-    PP->addPPCallbacks(::std::make_unique<SDLIncludeCallback>(*this, SM));
-  }
+// Helper: reports the rename of Row (a function, symbol or type row) at
+// Sites, the spellings of its SDL2 name, in one diagnostic at the first site
+static void EmitRename(ClangTidyCheck &Check, const MigrationEntry &Row,
+                       ArrayRef<SourceRange> Sites) {
+  llvm::TimeTraceScope Trace("SDL3 fix-it", Row.OldName);
+  // %0, %1: the names; %2: the note; %3: the number of sites
+  llvm::SmallString<80> Message(Row.Kind == MigrationKind::FunctionRename
+                                    ? "%0() has been renamed to %1() in SDL3"
+                                    : "%0 has been renamed to %1 in SDL3");
+  if (!Row.Note.empty())
+    Message += " (%2)";
+  if (Sites.size() > 1)
+    Message += ", at %3 sites in this file";
+  auto Diag = Report(Check, Sites.front().getBegin(), Message);
+  Diag << Row.OldName << Row.NewName << Row.Note
+       << static_cast<unsigned>(Sites.size());
+  if (BuildsFixes(Check))
+    for (SourceRange Site : Sites)
+      Diag << FixItHint::CreateReplacement(Site, Row.NewName);
+}
 
-  void registerMatchers(ast_matchers::MatchFinder *Finder) override {
-    for (const auto &R : RectFuncRenames)
-      Finder->addMatcher(
-          callExpr(callee(functionDecl(hasName(R[0])))).bind(R[0]), this);
-  }
+// Helper: reports the removal of Row's function, called at Loc
+static void EmitRemoval(ClangTidyCheck &Check, SourceLocation Loc,
+                        const MigrationEntry &Row) {
+  if (Row.Note.empty())
+    Report(Check, Loc, "%0() has been removed in SDL3") << Row.OldName;
+  else
+    Report(Check, Loc, "%0() has been removed in SDL3; %1")
+        << Row.OldName << Row.Note;
+}
 
-  void check(const ast_matchers::MatchFinder::MatchResult &Result) override {
-    for (const auto &R : RectFuncRenames) {
-      if (const auto *Call = Result.Nodes.getNodeAs<CallExpr>(R[0])) {
-        diag(Call->getBeginLoc(), "%0() has been renamed to %1() in SDL3")
-            << R[0] << R[1]
-            << FixItHint::CreateReplacement(Call->getCallee()->getSourceRange(),
-                                            R[1]);
-        return;
-      }
-    }
-  }
-};
+// Helper: reports Row at Site now, or holds it for the TU's summary
+static void EmitSite(ClangTidyCheck &Check, SourceRange Site,
+                     const MigrationEntry &Row) {
+  SDLTUState *TU = SDLTUState::Current;
+  if (Row.Kind == MigrationKind::RemovedFunction)
+    EmitRemoval(Check, Site.getBegin(), Row);
+  else if (!TU || !TU->Summary.add(Check, Site, Row))
+    EmitRename(Check, Row, Site);
+}
 
-// ===========================================================================
-// SDL3SurfaceCheck  (SDL_surface.h)
-// ===========================================================================
-static const char *SurfaceFuncRenames[][2] = {
-    {"SDL_BlitScaled", "SDL_BlitSurfaceScaled"},
-    {"SDL_ConvertSurfaceFormat", "SDL_ConvertSurface"},
-    {"SDL_FillRect", "SDL_FillSurfaceRect"},
-    {"SDL_FillRects", "SDL_FillSurfaceRects"},
-    {"SDL_FreeSurface", "SDL_DestroySurface"},
-    {"SDL_GetClipRect", "SDL_GetSurfaceClipRect"},
-    {"SDL_GetColorKey", "SDL_GetSurfaceColorKey"},
-    {"SDL_HasColorKey", "SDL_SurfaceHasColorKey"},
-    {"SDL_HasSurfaceRLE", "SDL_SurfaceHasRLE"},
-    {"SDL_LoadBMP_RW", "SDL_LoadBMP_IO"},
-    {"SDL_LowerBlit", "SDL_BlitSurfaceUnchecked"},
-    {"SDL_LowerBlitScaled", "SDL_BlitSurfaceUncheckedScaled"},
-    {"SDL_SaveBMP_RW", "SDL_SaveBMP_IO"},
-    {"SDL_SetClipRect", "SDL_SetSurfaceClipRect"},
-    {"SDL_SetColorKey", "SDL_SetSurfaceColorKey"},
-    {"SDL_UpperBlit", "SDL_BlitSurface"},
-    {"SDL_UpperBlitScaled", "SDL_BlitSurfaceScaled"},
-};
+// Helper: reports Row at Site, a match of the AST paths, unless Row's name
+// is spelled in the body of one of the TU's macros there; that is reported
+// once, at the end of the TU (see SDLMacroDefinitions)
+static void EmitMatchedSite(ClangTidyCheck &Check, SourceRange Site,
+                            const MigrationEntry &Row) {
+  SDLTUState *TU = SDLTUState::Current;
+  if (!TU || !TU->MacroDefinitions.defer(Check, Site, Row))
+    EmitSite(Check, Site, Row);
+}
 
-static const char *SurfaceRemovedFuncs[] = {
-    "SDL_FreeFormat",
-    "SDL_GetYUVConversionMode",
-    "SDL_GetYUVConversionModeForResolution",
-    "SDL_SetYUVConversionMode",
-    "SDL_SoftStretch",
-    "SDL_SoftStretchLinear",
-};
+static void EmitCallMigration(ClangTidyCheck &Check, const CallExpr *Call,
+                              const MigrationEntry &Row) {
+  SDLStats::charge(KindName(Row.Kind), Row.OldName);
+  EmitMatchedSite(Check,
+                  Row.Kind == MigrationKind::RemovedFunction
+                      ? SourceRange(Call->getBeginLoc())
+                      : Call->getCallee()->getSourceRange(),
+                  Row);
+}
 
-class SDL3SurfaceCheck : public ClangTidyCheck {
-public:
-  SDL3SurfaceCheck(StringRef Name, ClangTidyContext *Context)
-      : ClangTidyCheck(Name, Context) {}
+// Range: the reference to Row's symbol or type: a DeclRefExpr, a macro name
+// or a type name
+static void EmitSymbolMigration(ClangTidyCheck &Check, SourceRange Range,
+                                const MigrationEntry &Row) {
+  SDLStats::charge(KindName(Row.Kind), Row.OldName);
+  EmitMatchedSite(Check, Range, Row);
+}
 
-  void registerPPCallbacks(const SourceManager &SM, Preprocessor *PP,
-                           Preprocessor *ModuleExpanderPP) override {
-    PP->addPPCallbacks(::std::make_unique<SDLIncludeCallback>(*this, SM));
+// Row kinds reported at calls
+static constexpr uint32_t CallKinds = MaskOf(MigrationKind::FunctionRename) |
+                                      MaskOf(MigrationKind::RemovedFunction);
+
+// Helper: the first template of Call's function whose argument patterns Call
+// matches, if any
+static const CallRewrite *FindCallRewrite(const CallExpr *Call) {
+  const CallRewriteSet *Set = SDLCallRewrites.lookup(CalleeName(Call));
+  if (!Set)
+    return nullptr;
+  for (const CallRewrite &Rewrite :
+       ArrayRef<CallRewrite>(SDLCallRewriteList).slice(Set->First,
+                                                       Set->Count)) {
+    ArrayRef<RewriteArg> Args = ArrayRef<RewriteArg>(SDLRewriteArgs)
+                                    .slice(Rewrite.FirstArg, Rewrite.NumArgs);
+    if (Args.size() != Call->getNumArgs())
+      continue;
+    bool Matches = true;
+    for (unsigned I = 0; Matches && I < Args.size(); ++I) {
+      if (Args[I].Any)
+        continue;
+      const auto *Literal =
+          dyn_cast<IntegerLiteral>(Call->getArg(I)->IgnoreParenImpCasts());
+      Matches = Literal && Literal->getValue() == Args[I].Literal;
+    }
+    if (Matches)
+      return &Rewrite;
   }
+  return nullptr;
+}
 
-  void registerMatchers(ast_matchers::MatchFinder *Finder) override {
-    for (const auto &R : SurfaceFuncRenames)
-      Finder->addMatcher(
-          callExpr(callee(functionDecl(hasName(R[0])))).bind(R[0]), this);
-
-    for (const auto &Removed : SurfaceRemovedFuncs)
-      Finder->addMatcher(
-          callExpr(callee(functionDecl(hasName(Removed)))).bind(Removed), this);
-
-    // SDL_CreateRGBSurface() and SDL_CreateRGBSurfaceWithFormat() ->
-    // SDL_CreateSurface()
-    Finder->addMatcher(
-        callExpr(callee(functionDecl(hasName("SDL_CreateRGBSurface"))))
-            .bind("sdl_create_rgb_surface"),
-        this);
-    Finder->addMatcher(callExpr(callee(functionDecl(
-                                    hasName("SDL_CreateRGBSurfaceWithFormat"))))
-                           .bind("sdl_create_rgb_surface_fmt"),
-                       this);
+static void EmitCallRewrite(ClangTidyCheck &Check, const CallExpr *Call,
+                            const CallRewrite &Rewrite,
+                            const SourceManager &SM,
+                            const LangOptions &LangOpts) {
+  if (!BuildsFixes(Check)) {
+    Report(Check, Call->getBeginLoc(), Rewrite.Message);
+    return;
+  }
+  llvm::TimeTraceScope Trace("SDL3 fix-it", CalleeName(Call));
+  llvm::SmallString<128> Replacement;
+  for (const RewritePiece &Piece :
+       ArrayRef<RewritePiece>(SDLRewritePieces)
+           .slice(Rewrite.FirstPiece, Rewrite.NumPieces)) {
+    Replacement += Piece.Text;
+    if (Piece.Arg >= 0)
+      Replacement += Lexer::getSourceText(
+          CharSourceRange::getTokenRange(
+              Call->getArg(Piece.Arg)->getSourceRange()),
+          SM, LangOpts);
   }
+  Report(Check, Call->getBeginLoc(), Rewrite.Message)
+      << FixItHint::CreateReplacement(Call->getSourceRange(), Replacement);
+}
 
-  void check(const ast_matchers::MatchFinder::MatchResult &Result) override {
-    for (const auto &R : SurfaceFuncRenames) {
-      if (const auto *Call = Result.Nodes.getNodeAs<CallExpr>(R[0])) {
-        diag(Call->getBeginLoc(), "%0() has been renamed to %1() in SDL3")
-            << R[0] << R[1]
-            << FixItHint::CreateReplacement(Call->getCallee()->getSourceRange(),
-                                            R[1]);
-        return;
-      }
-    }
-    for (const auto &Removed : SurfaceRemovedFuncs) {
-      if (const auto *Call = Result.Nodes.getNodeAs<CallExpr>(Removed)) {
-        diag(Call->getBeginLoc(), "%0() has been removed in SDL3") << Removed;
-        return;
-      }
-    }
-    if (Result.Nodes.getNodeAs<CallExpr>("sdl_create_rgb_surface")) {
-      const auto *Call =
-          Result.Nodes.getNodeAs<CallExpr>("sdl_create_rgb_surface");
-      diag(Call->getBeginLoc(),
-           "SDL_CreateRGBSurface() has been replaced by SDL_CreateSurface() "
-           "in SDL3; use SDL_GetPixelFormatForMasks() to convert masks to a "
-           "pixel format");
-      return;
+// ---------------------------------------------------------------------------
+// SDLIncludeMigrator: the one PPCallbacks object of a TU, however many checks
+// are enabled. It rewrites the SDL2 #include directives of the main file to
+// SDL3 paths and records which checks' SDL2 headers the TU reaches in the
+// TU's SDLTUState, which it owns. The first check to register PP callbacks in
+// a TU installs it; the others subscribe to it. The include rewrites are
+// reported by the first subscriber that does not stand down (see
+// standsDown()).
+//
+// It also renames the SDL2 macros of the symbol tables (AUDIO_S16,
+// SDL_BUTTON, RW_SEEK_SET, ...), which leave no decl for the AST matchers to
+// see, as the preprocessor expands them. The renames are reported after
+// matching, by finishTranslationUnit(), so that a fix rewriting a whole call or
+// argument can claim() the macro names it already spells out.
+// ---------------------------------------------------------------------------
+class SDLIncludeMigrator : public PPCallbacks {
+public:
+  // What a check asks of the TU's migrator, from its options
+  struct Subscription {
+    // The checks whose macro renames the check reports, unless an earlier
+    // subscriber does
+    uint32_t SubsystemMask = 0;
+    // The check's migration database, if any; the rows of every
+    // subscriber's database apply to the whole TU
+    const MigrationDatabase *Database = nullptr;
+    // Where to write the TU's SDLStats, if not empty; the first subscriber
+    // with one decides
+    StringRef StatsDirectory;
+    // The SDLProjectHeaders directory, if not empty, and whether to replay
+    // its records; the first subscriber with one decides
+    StringRef HeaderCache;
+    bool ReplayHeaders = false;
+    // The check's name and the options its findings depend on
+    std::string Fingerprint;
+    bool Summary = false;    // hold the renames for the TU's SDLRenameSummary
+    bool ReportOnly = false; // build no fixes
+    bool Verbose = false;
+  };
+
+  static void subscribe(ClangTidyCheck &Check, const SourceManager &SM,
+                        Preprocessor *PP, const Subscription &Options) {
+    if (!Current || Current->PP != PP) {
+      auto Migrator = ::std::make_unique<SDLIncludeMigrator>(Check, SM, PP);
+      Current = Migrator.get();
+      PP->addPPCallbacks(std::move(Migrator));
     }
-    if (Result.Nodes.getNodeAs<CallExpr>("sdl_create_rgb_surface_fmt")) {
-      const auto *Call =
-          Result.Nodes.getNodeAs<CallExpr>("sdl_create_rgb_surface_fmt");
-      diag(Call->getBeginLoc(),
-           "SDL_CreateRGBSurfaceWithFormat() has been replaced by "
-           "SDL_CreateSurface() in SDL3")
-          << FixItHint::CreateReplacement(Call->getCallee()->getSourceRange(),
-                                          "SDL_CreateSurface");
-      return;
+    SDLTUState &State = Current->State;
+    Current->Subscribers.push_back({&Check, Options.SubsystemMask});
+    if (Options.Database)
+      State.Memo.addDatabase(Options.Database);
+    if (!Options.StatsDirectory.empty() && !State.Stats) {
+      State.Stats = std::make_unique<SDLStats>();
+      Current->StatsDirectory = Options.StatsDirectory.str();
     }
+    State.ProjectHeaders.enable(Options.HeaderCache, Options.ReplayHeaders, SM,
+                                PP->getLangOpts());
+    State.ProjectHeaders.configure(Options.Fingerprint);
+    if (Options.Summary)
+      State.Summary.enable(Check, SM);
+    if (Options.ReportOnly)
+      State.ReportOnly.insert(&Check);
+    Current->Verbose |= Options.Verbose;
   }
-};
-
-// ===========================================================================
-// SDL3IOStreamCheck  (SDL_rwops.h -> SDL_iostream.h)
-// ===========================================================================
-static const char *IOStreamFuncRenames[][2] = {
-    {"SDL_RWFromConstMem", "SDL_IOFromConstMem"},
-    {"SDL_RWFromFile", "SDL_IOFromFile"},
-    {"SDL_RWFromMem", "SDL_IOFromMem"},
-    {"SDL_RWclose", "SDL_CloseIO"},
-    {"SDL_RWread", "SDL_ReadIO"},
-    {"SDL_RWseek", "SDL_SeekIO"},
-    {"SDL_RWsize", "SDL_GetIOSize"},
-    {"SDL_RWtell", "SDL_TellIO"},
-    {"SDL_RWwrite", "SDL_WriteIO"},
-    {"SDL_ReadBE16", "SDL_ReadU16BE"},
-    {"SDL_ReadBE32", "SDL_ReadU32BE"},
-    {"SDL_ReadBE64", "SDL_ReadU64BE"},
-    {"SDL_ReadLE16", "SDL_ReadU16LE"},
-    {"SDL_ReadLE32", "SDL_ReadU32LE"},
-    {"SDL_ReadLE64", "SDL_ReadU64LE"},
-    {"SDL_WriteBE16", "SDL_WriteU16BE"},
-    {"SDL_WriteBE32", "SDL_WriteU32BE"},
-    {"SDL_WriteBE64", "SDL_WriteU64BE"},
-    {"SDL_WriteLE16", "SDL_WriteU16LE"},
-    {"SDL_WriteLE32", "SDL_WriteU32LE"},
-    {"SDL_WriteLE64", "SDL_WriteU64LE"},
-};
 
-static const char *IOStreamRemovedFuncs[] = {
-    "SDL_AllocRW",
-    "SDL_FreeRW",
-    "SDL_RWFromFP",
-};
+  // Whether Check stands down in the TU being processed: another subscriber
+  // migrates every subsystem Check does and more (sdl3-migration-all, which
+  // the sdl3-migration-* glob enables along with the others), so only that
+  // one reports
+  static bool standsDown(const ClangTidyCheck &Check) {
+    if (!Current)
+      return false;
+    const auto *Own =
+        llvm::find_if(Current->Subscribers,
+                      [&](const Subscriber &S) { return S.Check == &Check; });
+    return Own != Current->Subscribers.end() && Current->covered(*Own);
+  }
 
-static const char *IOStreamSymbolRenames[][2] = {
-    {"RW_SEEK_CUR", "SDL_IO_SEEK_CUR"},
-    {"RW_SEEK_END", "SDL_IO_SEEK_END"},
-    {"RW_SEEK_SET", "SDL_IO_SEEK_SET"},
-};
+  // Suppresses the macro renames spelled inside Range, which a fix replaces
+  // as a whole
+  static void claim(SourceRange Range) {
+    if (!Current)
+      return;
+    CharSourceRange FileRange = Lexer::makeFileCharRange(
+        CharSourceRange::getTokenRange(Range), Current->SM,
+        Current->PP->getLangOpts());
+    if (FileRange.isValid())
+      Current->Claimed.push_back(FileRange);
+  }
 
-class SDL3IOStreamCheck : public ClangTidyCheck {
-public:
-  SDL3IOStreamCheck(StringRef Name, ClangTidyContext *Context)
-      : ClangTidyCheck(Name, Context) {}
+  // Reports the macro renames recorded while preprocessing the TU, the
+  // migrations deferred to the TU's macro definitions, the renames held for a
+  // summary and the replayed findings of the project headers, and writes the
+  // TU's header records, stats and trace; the first check to finish the TU
+  // does it for all
+  static void finishTranslationUnit() {
+    SDLTrace::finishMatching();
+    if (!Current)
+      return;
+    const SourceManager &SM = Current->SM;
+    SDLStats *Stats = Current->State.Stats.get();
+    auto Claimed = [&](SourceLocation Loc) {
+      return llvm::any_of(Current->Claimed, [&](CharSourceRange R) {
+        return !SM.isBeforeInTranslationUnit(Loc, R.getBegin()) &&
+               SM.isBeforeInTranslationUnit(Loc, R.getEnd());
+      });
+    };
+    for (const MacroRename &Rename : Current->MacroRenames) {
+      if (Claimed(Rename.Loc))
+        continue;
+      SDLStats::Scope Scope(Stats, CheckName(*Rename.Check));
+      EmitSymbolMigration(*Rename.Check, SourceRange(Rename.Loc), *Rename.Row);
+    }
+    Current->MacroRenames.clear();
+    for (const SDLMacroDefinitions::Site &Site :
+         Current->State.MacroDefinitions.sites()) {
+      if (Claimed(Site.Loc))
+        continue;
+      SDLStats::Scope Scope(Stats, CheckName(*Site.Check));
+      EmitSite(*Site.Check, SourceRange(Site.Loc), *Site.Row);
+    }
+    Current->State.MacroDefinitions.clear();
+    for (const SDLRenameSummary::Group &Group :
+         Current->State.Summary.groups())
+      EmitRename(*Group.Check, *Group.Row, Group.Sites);
+    Current->State.Summary.clear();
+    Current->State.ProjectHeaders.finish(
+        Current->PP->getDiagnostics().hasErrorOccurred(),
+        [&](FileID FID, const HeaderFinding &Finding) {
+          Current->replay(FID, Finding);
+        });
+    OptionalFileEntryRef Main = SM.getFileEntryRefForID(SM.getMainFileID());
+    StringRef MainFile = Main ? Main->getName() : StringRef("stdin");
+    if (Stats) {
+      Stats->write(Current->StatsDirectory, MainFile);
+      Current->State.Stats.reset();
+    }
+    SDLTrace::finish(MainFile);
+  }
 
-  void registerPPCallbacks(const SourceManager &SM, Preprocessor *PP,
-                           Preprocessor *ModuleExpanderPP) override {
-    PP->addPPCallbacks(::std::make_unique<SDLIncludeCallback>(*this, SM));
+  SDLIncludeMigrator(ClangTidyCheck &Check, const SourceManager &SM,
+                     const Preprocessor *PP)
+      : Check(Check), SM(SM), PP(PP) {
+    SDLTUState::Current = &State;
   }
 
-  void registerMatchers(ast_matchers::MatchFinder *Finder) override {
-    for (const auto &R : IOStreamFuncRenames)
-      Finder->addMatcher(
-          callExpr(callee(functionDecl(hasName(R[0])))).bind(R[0]), this);
+  // The preprocessor owns its callbacks, so this runs when the TU is done
+  ~SDLIncludeMigrator() override {
+    if (Verbose)
+      llvm::outs() << "decl memo: " << State.Memo.hits() << " hits, "
+                   << State.Memo.misses() << " misses\n";
+    if (SDLTUState::Current == &State)
+      SDLTUState::Current = nullptr;
+    if (Current == this)
+      Current = nullptr;
+  }
 
-    for (const auto &Removed : IOStreamRemovedFuncs)
-      Finder->addMatcher(
-          callExpr(callee(functionDecl(hasName(Removed)))).bind(Removed), this);
+  void FileChanged(SourceLocation Loc, FileChangeReason Reason,
+                   SrcMgr::CharacteristicKind FileType,
+                   FileID PrevFID) override {
+    if (Reason == EnterFile)
+      State.ProjectHeaders.enterFile(SM, SM.getFileID(Loc), FileType);
+  }
 
-    for (const auto &S : IOStreamSymbolRenames)
-      Finder->addMatcher(declRefExpr(to(namedDecl(hasName(S[0])))).bind(S[0]),
-                         this);
+  // Records the expansions of SDL2 macros with a symbol row whose name is
+  // spelled in user code, once per spelling (a user macro wrapping one is
+  // renamed in its definition)
+  void MacroExpands(const Token &MacroNameTok, const MacroDefinition &MD,
+                    SourceRange Range, const MacroArgs *Args) override {
+    llvm::TimeTraceScope Trace("SDL3 preprocessor callbacks");
+    const MigrationEntry *Row =
+        SDLMigrations.lookup(MacroNameTok.getIdentifierInfo()->getName());
+    if (!Row || Row->Kind != MigrationKind::SymbolRename)
+      return;
+    const auto *Owner = llvm::find_if(Subscribers, [&](const Subscriber &S) {
+      return (S.SubsystemMask & MaskOf(Row->Check)) && !covered(S);
+    });
+    if (Owner == Subscribers.end())
+      return;
+    const MacroInfo *Info = MD.getMacroInfo();
+    SourceLocation Loc = SM.getSpellingLoc(MacroNameTok.getLocation());
+    if (!Info || !State.Headers.isSDLHeader(SM, Info->getDefinitionLoc()) ||
+        SM.isInSystemHeader(Loc) || SM.isWrittenInScratchSpace(Loc) ||
+        State.Headers.isSDLHeader(SM, Loc) || !Renamed.insert(Loc).second)
+      return;
+    MacroRenames.push_back({Owner->Check, Loc, Row});
   }
 
-  void check(const ast_matchers::MatchFinder::MatchResult &Result) override {
-    for (const auto &R : IOStreamFuncRenames) {
-      if (const auto *Call = Result.Nodes.getNodeAs<CallExpr>(R[0])) {
-        diag(Call->getBeginLoc(), "%0() has been renamed to %1() in SDL3")
-            << R[0] << R[1]
-            << FixItHint::CreateReplacement(Call->getCallee()->getSourceRange(),
-                                            R[1]);
-        return;
-      }
-    }
-    for (const auto &Removed : IOStreamRemovedFuncs) {
-      if (const auto *Call = Result.Nodes.getNodeAs<CallExpr>(Removed)) {
-        if (StringRef(Removed) == "SDL_RWFromFP") {
-          diag(Call->getBeginLoc(),
-               "SDL_RWFromFP() has been removed; implement a custom "
-               "SDL_IOStream using SDL_OpenIO() instead");
-        } else {
-          diag(Call->getBeginLoc(), "%0() has been removed in SDL3") << Removed;
-        }
-        return;
+  // Notes the names with a migration table row spelled in the body of a
+  // macro the project defines, so that the matches in its expansions are
+  // migrated once, in the definition (see SDLMacroDefinitions)
+  void MacroDefined(const Token &MacroNameTok,
+                    const MacroDirective *MD) override {
+    llvm::TimeTraceScope Trace("SDL3 preprocessor callbacks");
+    const MacroInfo *Info = MD->getMacroInfo();
+    SourceLocation Loc = MD->getLocation();
+    if (Info->getNumTokens() == 0 || SM.isInSystemHeader(Loc) ||
+        !SM.getFileEntryRefForID(SM.getFileID(Loc)) ||
+        State.Headers.isSDLHeader(SM, Loc))
+      return;
+    bool Noted = false;
+    for (const Token &Tok : Info->tokens()) {
+      if (!Tok.is(tok::identifier))
+        continue;
+      StringRef Name = Tok.getIdentifierInfo()->getName();
+      if (SDLMigrations.lookup(Name) ||
+          llvm::any_of(State.Memo.databases(),
+                       [&](const MigrationDatabase *Database) {
+                         return Database->lookup(Name).has_value();
+                       })) {
+        State.MacroDefinitions.addName(SM, Tok.getLocation());
+        Noted = true;
       }
     }
-    for (const auto &S : IOStreamSymbolRenames) {
-      if (const auto *DRE = Result.Nodes.getNodeAs<DeclRefExpr>(S[0])) {
-        diag(DRE->getBeginLoc(), "%0 has been renamed to %1 in SDL3")
-            << S[0] << S[1]
-            << FixItHint::CreateReplacement(DRE->getSourceRange(), S[1]);
-        return;
-      }
+    if (Noted)
+      State.ProjectHeaders.keepUncached(Loc);
+  }
+
+  void InclusionDirective(SourceLocation HashLoc, const Token &IncludeTok,
+                          StringRef FileName, bool isAngled,
+                          CharSourceRange FilenameRange,
+                          OptionalFileEntryRef file, StringRef SearchPath,
+                          StringRef RelativePath, const Module *imported,
+                          bool ModuleImported,
+                          SrcMgr::CharacteristicKind FileType) override {
+    llvm::TimeTraceScope Trace("SDL3 preprocessor callbacks");
+    // Init's error-check patterns apply to calls into any subsystem, so
+    // every SDL2 header counts for it
+    if (file) {
+      StringRef Header = llvm::sys::path::filename(file->getName());
+      if (IsSDL2Header(*file))
+        State.Included |=
+            SDLHeaderChecks.checksOf(Header) | MaskOf(MigrationCheck::Init);
+      for (const MigrationDatabase *Database : State.Memo.databases())
+        State.Included |= Database->checksOf(Header);
+    }
+    if (!SM.isInMainFile(HashLoc)) {
+      return;
+    }
+    if (FileName.contains("SDL") ||
+        FileName.contains("SDL2") && !FileName.contains("SDL3")) {
+      if (Verbose) {
+        llvm::outs() << "Found an SDL or SDL2 file\n";
+        llvm::outs() << "File Entry actually exists\n";
+        llvm::outs() << "FileName is:  " << FileName << "\n";
+      }
+      std::string Replacement;
+      if (FileName == "SDL2/SDL.h") {
+        Replacement = "SDL3/SDL.h";
+      } else if (FileName == "SDL2/SDL_gamecontroller.h") {
+        Replacement = "SDL3/SDL_gamepad.h";
+      } else if (FileName.starts_with("SDL2/")) {
+        Replacement = "SDL3/" + FileName.substr(5).str();
+      } else if (FileName == "SDL.h") {
+        Replacement = "SDL3/SDL.h";
+      } else if (FileName.starts_with("SDL_")) {
+        Replacement = "SDL3/" + FileName.str();
+      }
+
+      if (!Replacement.empty()) {
+        if (Verbose)
+          llvm::outs() << "Replacement is not empty\n";
+        ClangTidyCheck &Reporter = reporter();
+        auto Diag = Reporter.diag(HashLoc, "replace with %0");
+        Diag << Replacement;
+        if (BuildsFixes(Reporter)) {
+          std::string FormattedReplacement =
+              isAngled ? ("<" + Replacement + ">")
+                       : ("\"" + Replacement + "\"");
+          Diag << FixItHint::CreateReplacement(FilenameRange,
+                                               FormattedReplacement);
+        }
+      }
     }
   }
+
+private:
+  struct Subscriber {
+    ClangTidyCheck *Check;
+    uint32_t SubsystemMask;
+  };
+
+  // Whether another subscriber migrates every subsystem S does and more
+  bool covered(const Subscriber &S) const {
+    return llvm::any_of(Subscribers, [&](const Subscriber &Other) {
+      return Other.SubsystemMask != S.SubsystemMask &&
+             (Other.SubsystemMask & S.SubsystemMask) == S.SubsystemMask;
+    });
+  }
+
+  // The check reporting the include rewrites: the first subscriber that does
+  // not stand down
+  ClangTidyCheck &reporter() const {
+    for (const Subscriber &S : Subscribers)
+      if (!covered(S))
+        return *S.Check;
+    return Check;
+  }
+
+  // Reports a finding of a project header's record again, through the
+  // subscriber that recorded it
+  void replay(FileID FID, const HeaderFinding &Finding) {
+    const auto *Owner = llvm::find_if(Subscribers, [&](const Subscriber &S) {
+      return CheckName(*S.Check) == Finding.Check;
+    });
+    if (Owner == Subscribers.end())
+      return;
+    SourceLocation Start = SM.getLocForStartOfFile(FID);
+    auto Diag = Owner->Check->diag(Start.getLocWithOffset(Finding.Offset),
+                                   Finding.Message);
+    for (const std::string &Arg : Finding.Args)
+      Diag << Arg;
+    for (const HeaderFinding::Fix &Fix : Finding.Fixes)
+      Diag << FixItHint::CreateReplacement(
+          CharSourceRange::getCharRange(
+              Start.getLocWithOffset(Fix.Offset),
+              Start.getLocWithOffset(Fix.Offset + Fix.Length)),
+          Fix.Text);
+  }
+
+  struct MacroRename {
+    ClangTidyCheck *Check;
+    SourceLocation Loc; // spelling of the macro name
+    const MigrationEntry *Row;
+  };
+
+  // Migrator of the TU being preprocessed on this thread
+  static inline thread_local SDLIncludeMigrator *Current = nullptr;
+
+  ClangTidyCheck &Check;
+  const SourceManager &SM;
+  const Preprocessor *PP;
+  llvm::SmallVector<Subscriber, 16> Subscribers;
+  SDLTUState State;
+  llvm::SmallVector<MacroRename, 16> MacroRenames;
+  llvm::DenseSet<SourceLocation> Renamed;
+  llvm::SmallVector<CharSourceRange, 8> Claimed;
+  std::string StatsDirectory;
+  bool Verbose = false;
 };
 
-// ===========================================================================
-// SDL3LogCheck  (SDL_log.h)
-// ===========================================================================
-static const char *LogFuncRenames[][2] = {
-    {"SDL_LogGetOutputFunction", "SDL_GetLogOutputFunction"},
-    {"SDL_LogGetPriority", "SDL_GetLogPriority"},
-    {"SDL_LogResetPriorities", "SDL_ResetLogPriorities"},
-    {"SDL_LogSetAllPriority", "SDL_SetLogPriorities"},
-    {"SDL_LogSetOutputFunction", "SDL_SetLogOutputFunction"},
-    {"SDL_LogSetPriority", "SDL_SetLogPriority"},
+// ---------------------------------------------------------------------------
+// SDLMatcherSet: the matchers of one check, by node kind. clang-tidy creates
+// the checks anew for every TU; a set is built by the first check of its name
+// and engine in the process and added to the MatchFinder of every later TU.
+// Matchers are immutable and reference counted thread-safely, so the set is
+// shared read-only between TUs and threads.
+// ---------------------------------------------------------------------------
+class SDLMatcherSet {
+public:
+  void add(const ast_matchers::DeclarationMatcher &Matcher) {
+    Decls.push_back(Matcher);
+  }
+  void add(const ast_matchers::StatementMatcher &Matcher) {
+    Stmts.push_back(Matcher);
+  }
+  // MatchFinder only applies the check's traversal kind to decl and statement
+  // matchers, so TypeLoc matchers get it here; otherwise a type spelled in a
+  // template would match once per instantiation
+  void add(const ast_matchers::TypeLocMatcher &Matcher) {
+    TypeLocs.push_back(traverse(TK_IgnoreUnlessSpelledInSource, Matcher));
+  }
+
+  void addTo(ast_matchers::MatchFinder *Finder,
+             ast_matchers::MatchFinder::MatchCallback *Callback) const {
+    for (const auto &Matcher : Decls)
+      Finder->addMatcher(Matcher, Callback);
+    for (const auto &Matcher : Stmts)
+      Finder->addMatcher(Matcher, Callback);
+    for (const auto &Matcher : TypeLocs)
+      Finder->addMatcher(Matcher, Callback);
+  }
+
+private:
+  std::vector<ast_matchers::DeclarationMatcher> Decls;
+  std::vector<ast_matchers::StatementMatcher> Stmts;
+  std::vector<ast_matchers::TypeLocMatcher> TypeLocs;
 };
 
-static const char *LogSymbolRenames[][2] = {
-    {"SDL_NUM_LOG_PRIORITIES", "SDL_LOG_PRIORITY_COUNT"},
+// Helper: first test of every top-level matcher of the checks migrating the
+// subsystems in SubsystemMask. Rejects every node of a TU that never includes
+// their SDL2 headers (one mask test per node), then nodes expanded in system
+// headers or in project headers with a record, before anything else about
+// them is looked at
+static auto FromUserCode(uint32_t SubsystemMask) {
+  return allOf(includesCheckedSDLHeader(SubsystemMask),
+               unless(isExpansionInSystemHeader()),
+               unless(isExpansionInRecordedHeader()));
+}
+
+// ---------------------------------------------------------------------------
+// SDLSubsystemHandler: the migrations of one subsystem that the tables cannot
+// express. A handler is a plain object owned by a check: it adds its matchers
+// to the check's matcher set and handles their matches, reporting under the
+// check's name. The check of the subsystem and sdl3-migration-all own a
+// handler of the same class each.
+// ---------------------------------------------------------------------------
+class SDLSubsystemHandler {
+public:
+  SDLSubsystemHandler(ClangTidyCheck &Check, MigrationCheck Subsystem,
+                      bool ReportOnly)
+      : Check(Check), SubsystemMask(MaskOf(Subsystem)),
+        ReportOnly(ReportOnly) {}
+  virtual ~SDLSubsystemHandler() = default;
+
+  virtual void addMatchers(SDLMatcherSet &Matchers) const = 0;
+
+  // Handles a match of addMatchers(); false for other matches
+  virtual bool
+  check(const ast_matchers::MatchFinder::MatchResult &Result) = 0;
+
+protected:
+  // Whether to only report where the SDL2 API is used (option ReportOnly),
+  // skipping the source text extraction and fixes
+  bool reportOnly() const { return ReportOnly; }
+
+  // ClangTidyCheck::diag() of the owning check, through the TU's
+  // SDLProjectHeaders
+  SDLDiagnostic diag(SourceLocation Loc, StringRef Message) {
+    return Report(Check, Loc, Message);
+  }
+
+  // Helper: see FromUserCode(); each handler keeps the header gate of its
+  // subsystem, whichever check owns it
+  auto fromUserCode() const { return FromUserCode(SubsystemMask); }
+
+  // Helper: callee() of a call to the SDL2 function FunctionName
+  auto callsSDLFunction(StringRef FunctionName) const {
+    return callee(functionDecl(isDeclaredInSDLHeader(), hasName(FunctionName)));
+  }
+
+  // Helper: SDL2 functions whose int error code became bool
+  auto hasBoolReturnRow() const { return hasSDLBoolReturn(SubsystemMask); }
+
+  // Helper: for fixes that insert code before the statement holding a match
+  // of Inner. Matches the blocks with such a statement, once for every match
+  // of Inner, and binds the statement as "anchor": the innermost one, as a
+  // nested block is an anchor's block itself. The block is searched top
+  // down, so finding the anchor costs no parent map.
+  auto
+  StatementAnchorMatcher(ast_matchers::internal::Matcher<Stmt> Inner) const {
+    return compoundStmt(
+        fromUserCode(),
+        forEach(stmt(unless(compoundStmt()), forEachOutsideBlocks(Inner))
+                    .bind("anchor")));
+  }
+
+private:
+  ClangTidyCheck &Check;
+  uint32_t SubsystemMask;
+  bool ReportOnly;
 };
 
-class SDL3LogCheck : public ClangTidyCheck {
+// ---------------------------------------------------------------------------
+// SDLMigrationCheck: base of all checks. A check migrates the table rows of a
+// set of subsystems, with one matcher per row kind for all of them, plus what
+// its subsystem handlers migrate. The table rows can instead be migrated by
+// one RecursiveASTVisitor walk of the TU (option Engine: visitor). The
+// matchers only depend on the check's subsystems; the per-TU state they test
+// (the SDL2 headers the TU reaches, the header cache and decl memo every
+// callee / referenced decl goes through) lives in SDLTUState.
+// ---------------------------------------------------------------------------
+class SDLMigrationCheck : public ClangTidyCheck {
 public:
-  SDL3LogCheck(StringRef Name, ClangTidyContext *Context)
-      : ClangTidyCheck(Name, Context) {}
+  // Subsystems: the tables the check migrates. The check does no matching in
+  // TUs that reach none of their SDL2 headers; with Init, whose error-check
+  // patterns apply to calls into any subsystem, every SDL2 header counts.
+  SDLMigrationCheck(StringRef Name, ClangTidyContext *Context,
+                    std::initializer_list<MigrationCheck> Subsystems)
+      : ClangTidyCheck(Name, Context),
+        SubsystemMask(SubsystemsMask(Subsystems)),
+        Verbose(Options.get("Verbose", false)),
+        UseVisitor(Options.get("Engine", "matchers") == "visitor"),
+        DatabasePath(Options.getLocalOrGlobal("MigrationDatabase", "")),
+        StatsDirectory(Options.getLocalOrGlobal("StatsDirectory", "")),
+        TraceDirectory(Options.getLocalOrGlobal("TraceDirectory", "")),
+        Summary(Options.getLocalOrGlobal("Summary", false)),
+        ReportOnly(Options.getLocalOrGlobal("ReportOnly", false)),
+        HeaderCache(Options.getLocalOrGlobal("HeaderCache", "")),
+        ReplayHeaders(Options.getLocalOrGlobal("ReplayHeaders", false)) {
+    SDLTrace::start(TraceDirectory);
+    if (DatabasePath.empty())
+      return;
+    std::string Error;
+    Database = MigrationDatabase::get(DatabasePath, Error);
+    if (!Database)
+      configurationDiag("cannot load migration database '%0': %1")
+          << DatabasePath << Error;
+  }
+
+  ~SDLMigrationCheck() override { SDLTrace::discard(); }
+
+  void storeOptions(ClangTidyOptions::OptionMap &Opts) override {
+    Options.store(Opts, "Verbose", Verbose);
+    Options.store(Opts, "Engine", UseVisitor ? "visitor" : "matchers");
+    Options.store(Opts, "MigrationDatabase", DatabasePath);
+    Options.store(Opts, "StatsDirectory", StatsDirectory);
+    Options.store(Opts, "TraceDirectory", TraceDirectory);
+    Options.store(Opts, "Summary", Summary);
+    Options.store(Opts, "ReportOnly", ReportOnly);
+    Options.store(Opts, "HeaderCache", HeaderCache);
+    Options.store(Opts, "ReplayHeaders", ReplayHeaders);
+  }
 
+  // Rewrites SDL2 includes and records whether the TU reaches the check's
+  // headers
   void registerPPCallbacks(const SourceManager &SM, Preprocessor *PP,
                            Preprocessor *ModuleExpanderPP) override {
-    PP->addPPCallbacks(::std::make_unique<SDLIncludeCallback>(*this, SM));
+    SDLIncludeMigrator::Subscription Subscription;
+    Subscription.SubsystemMask = SubsystemMask;
+    Subscription.Database = Database;
+    Subscription.StatsDirectory = StatsDirectory;
+    Subscription.HeaderCache = HeaderCache;
+    Subscription.ReplayHeaders = ReplayHeaders;
+    Subscription.Fingerprint = (getID() + ":" + Twine(SubsystemMask) + ":" +
+                                DatabasePath + ":" + Twine(Summary) +
+                                Twine(ReportOnly))
+                                   .str();
+    Subscription.Summary = Summary;
+    Subscription.ReportOnly = ReportOnly;
+    Subscription.Verbose = Verbose;
+    SDLIncludeMigrator::subscribe(*this, SM, PP, Subscription);
   }
 
-  void registerMatchers(ast_matchers::MatchFinder *Finder) override {
-    for (const auto &R : LogFuncRenames)
-      Finder->addMatcher(
-          callExpr(callee(functionDecl(hasName(R[0])))).bind(R[0]), this);
+  void onStartOfTranslationUnit() override { SDLTrace::startMatching(); }
 
-    for (const auto &S : LogSymbolRenames)
-      Finder->addMatcher(declRefExpr(to(namedDecl(hasName(S[0])))).bind(S[0]),
-                         this);
+  // Matching is done, so no fix can claim a macro name any more
+  void onEndOfTranslationUnit() override {
+    SDLIncludeMigrator::finishTranslationUnit();
+  }
+
+  void registerMatchers(ast_matchers::MatchFinder *Finder) override {
+    llvm::TimeTraceScope Trace("SDL3 matcher registration",
+                               [&] { return getID().str(); });
+    matchers().addTo(Finder, this);
   }
 
   void check(const ast_matchers::MatchFinder::MatchResult &Result) override {
-    for (const auto &R : LogFuncRenames) {
-      if (const auto *Call = Result.Nodes.getNodeAs<CallExpr>(R[0])) {
-        diag(Call->getBeginLoc(), "%0() has been renamed to %1() in SDL3")
-            << R[0] << R[1]
-            << FixItHint::CreateReplacement(Call->getCallee()->getSourceRange(),
-                                            R[1]);
-        return;
+    if (SDLIncludeMigrator::standsDown(*this))
+      return;
+    llvm::TimeTraceScope Trace("SDL3 check()", [&] { return getID().str(); });
+    SDLStats::Scope Scope(CurrentStats(), getID());
+    if (!llvm::any_of(Handlers, [&](const auto &Handler) {
+          return Handler->check(Result);
+        }))
+      checkTables(Result);
+  }
+
+  // Match code as written only: implicit casts, template instantiations and
+  // other compiler-generated nodes are not traversed, so a call inside a
+  // template is reported once, at its spelling
+  std::optional<TraversalKind> getCheckTraversalKind() const override {
+    return TK_IgnoreUnlessSpelledInSource;
+  }
+
+protected:
+  // Adds a handler of what the tables cannot express in one subsystem. The
+  // handlers' matchers go into the check's set, their matches to them first.
+  template <typename Handler> void addHandler() {
+    Handlers.push_back(std::make_unique<Handler>(*this, ReportOnly));
+  }
+
+private:
+  // Helper: see FromUserCode()
+  auto fromUserCode() const { return FromUserCode(SubsystemMask); }
+
+  // Helper: SDL2 decls with a row of a kind in KindMask in the check's
+  // subsystems
+  auto hasSubsystemRow(uint32_t KindMask) const {
+    return hasSDLRow(SubsystemMask, KindMask);
+  }
+
+  // The check's matchers, built by the first check of this name, engine and
+  // database in the process and shared by all later ones
+  const SDLMatcherSet &matchers() const {
+    static std::mutex Lock;
+    static llvm::StringMap<std::unique_ptr<SDLMatcherSet>> Built;
+    std::lock_guard<std::mutex> Guard(Lock);
+    std::unique_ptr<SDLMatcherSet> &Set =
+        Built[(getID() + (UseVisitor ? ".visitor:" : ".matchers:") +
+               (Database ? DatabasePath : ""))
+                  .str()];
+    if (!Set) {
+      Set = std::make_unique<SDLMatcherSet>();
+      addTableMatchers(*Set);
+      for (const auto &Handler : Handlers)
+        Handler->addMatchers(*Set);
+    }
+    return *Set;
+  }
+
+  // One matcher for every call to a function with a row, one for every
+  // reference to a symbol with a row, one for every spelling of a type with a
+  // row and one for every call to a function with a rewrite template,
+  // whatever the number of subsystems; check() resolves the row from the
+  // callee / referenced decl. A database may hold rows of any kind for any
+  // check, so with one every row matcher is added.
+  void addTableMatchers(SDLMatcherSet &Matchers) const {
+    if (UseVisitor) {
+      Matchers.add(
+          translationUnitDecl(includesCheckedSDLHeader(SubsystemMask))
+              .bind("sdl_tu"));
+      return;
+    }
+
+    if (Database || SDLMigrations.hasRows(SubsystemMask, CallKinds))
+      Matchers.add(callExpr(fromUserCode(),
+                            callee(functionDecl(hasSubsystemRow(CallKinds))))
+                       .bind("sdl_call"));
+
+    uint32_t Symbols = MaskOf(MigrationKind::SymbolRename);
+    if (Database || SDLMigrations.hasRows(SubsystemMask, Symbols))
+      Matchers.add(declRefExpr(fromUserCode(),
+                               to(namedDecl(hasSubsystemRow(Symbols))))
+                       .bind("sdl_symbol"));
+
+    // Matches the type name itself, wherever it is spelled: variables,
+    // parameters, fields, casts, sizeof, template arguments, typedefs.
+    // Pointer, const and elaborated types around it are left to the match of
+    // the name, so each spelling is rewritten once.
+    uint32_t Types = MaskOf(MigrationKind::TypeRename);
+    if (Database || SDLMigrations.hasRows(SubsystemMask, Types)) {
+      auto TypeDecl = namedDecl(hasSubsystemRow(Types));
+      Matchers.add(
+          typeLoc(fromUserCode(), unless(qualifiedTypeLoc()),
+                  loc(qualType(anyOf(typedefType(hasDeclaration(TypeDecl)),
+                                     recordType(hasDeclaration(TypeDecl))))),
+                  unless(isSpelledInSDLHeader()))
+              .bind("sdl_type_loc"));
+    }
+
+    if (SDLCallRewrites.hasRows(SubsystemMask))
+      Matchers.add(
+          callExpr(fromUserCode(),
+                   callee(functionDecl(hasSDLCallRewrite(SubsystemMask))))
+              .bind("sdl_rewrite"));
+  }
+
+  // The "visitor" engine: looks every call, symbol reference and type name of
+  // the TU up in the tables directly. Like the matchers, it walks code as
+  // written (no template instantiations or implicit code) outside system
+  // headers, and reports the same rows with the same fixes.
+  class TableVisitor : public RecursiveASTVisitor<TableVisitor> {
+  public:
+    TableVisitor(SDLMigrationCheck &Check, SDLTUState &TU,
+                 const ASTContext &Context)
+        : Check(Check), TU(TU), SM(Context.getSourceManager()),
+          LangOpts(Context.getLangOpts()) {}
+
+    // Declarations in system headers hold nothing to migrate, and those of
+    // project headers with a record are migrated by it; skip them without
+    // walking their contents
+    bool TraverseDecl(Decl *D) {
+      if (D && !isa<TranslationUnitDecl>(D) &&
+          (inSystemHeader(D->getLocation()) || inRecordedHeader(D)))
+        return true;
+      return RecursiveASTVisitor::TraverseDecl(D);
+    }
+
+    bool VisitCallExpr(CallExpr *Call) {
+      const FunctionDecl *Callee = Call->getDirectCallee();
+      if (!Callee)
+        return true;
+      SDLDeclMemo::Rows Rows = TU.Memo.lookup(Callee, SM);
+      const auto *Row = Rows.row(Check.SubsystemMask, CallKinds);
+      bool Rewrites = Rows.rewrites(Check.SubsystemMask);
+      if ((!Row && !Rewrites) || inSystemHeader(Call->getBeginLoc()))
+        return true;
+      if (Row) {
+        SDLStats::Scope Scope(TU.Stats.get(), Check.getID());
+        EmitCallMigration(Check, Call, *Row);
       }
+      if (Rewrites) {
+        SDLStats::Scope Scope(TU.Stats.get(), Check.getID());
+        Check.migrateCallRewrite(Call, SM, LangOpts);
+      }
+      return true;
     }
-    for (const auto &S : LogSymbolRenames) {
-      if (const auto *DRE = Result.Nodes.getNodeAs<DeclRefExpr>(S[0])) {
-        diag(DRE->getBeginLoc(), "%0 has been renamed to %1 in SDL3")
-            << S[0] << S[1]
-            << FixItHint::CreateReplacement(DRE->getSourceRange(), S[1]);
-        return;
+
+    bool VisitDeclRefExpr(DeclRefExpr *DRE) {
+      const auto *Row =
+          TU.Memo.lookup(DRE->getDecl(), SM)
+              .row(Check.SubsystemMask, MaskOf(MigrationKind::SymbolRename));
+      if (Row && !inSystemHeader(DRE->getBeginLoc())) {
+        SDLStats::Scope Scope(TU.Stats.get(), Check.getID());
+        EmitSymbolMigration(Check, DRE->getSourceRange(), *Row);
+      }
+      return true;
+    }
+
+    bool VisitTypedefTypeLoc(TypedefTypeLoc TL) {
+      return visitTypeName(TL, TL.getTypedefNameDecl());
+    }
+    bool VisitRecordTypeLoc(RecordTypeLoc TL) {
+      return visitTypeName(TL, TL.getDecl());
+    }
+
+  private:
+    bool inSystemHeader(SourceLocation Loc) {
+      SourceLocation ExpansionLoc = SM.getExpansionLoc(Loc);
+      return ExpansionLoc.isValid() && SM.isInSystemHeader(ExpansionLoc);
+    }
+
+    bool inRecordedHeader(const Decl *D) {
+      return TU.ProjectHeaders.enabled() &&
+             TU.ProjectHeaders.isCached(
+                 SM.getFileID(SM.getExpansionLoc(D->getLocation())));
+    }
+
+    bool visitTypeName(TypeLoc TL, const NamedDecl *D) {
+      if (!D)
+        return true;
+      const auto *Row = TU.Memo.lookup(D, SM).row(
+          Check.SubsystemMask, MaskOf(MigrationKind::TypeRename));
+      if (Row && !inSystemHeader(TL.getBeginLoc()) &&
+          !TU.Headers.isSDLHeader(SM, TL.getBeginLoc())) {
+        SDLStats::Scope Scope(TU.Stats.get(), Check.getID());
+        EmitSymbolMigration(Check, TL.getSourceRange(), *Row);
       }
+      return true;
+    }
+
+    SDLMigrationCheck &Check;
+    SDLTUState &TU;
+    const SourceManager &SM;
+    const LangOptions &LangOpts;
+  };
+
+  // Reports the template of Call's function that Call matches, if any; only
+  // then is it a hit of the function's rewrite row
+  void migrateCallRewrite(const CallExpr *Call, const SourceManager &SM,
+                          const LangOptions &LangOpts) {
+    if (const auto *Rewrite = FindCallRewrite(Call)) {
+      SDLStats::charge("rewrite", CalleeName(Call));
+      EmitCallRewrite(*this, Call, *Rewrite, SM, LangOpts);
+      SDLIncludeMigrator::claim(Call->getSourceRange());
     }
   }
-};
 
-// ===========================================================================
-// SDL3PixelsCheck  (SDL_pixels.h)
-// ===========================================================================
-static const char *PixelsFuncRenames[][2] = {
-    {"SDL_AllocFormat", "SDL_GetPixelFormatDetails"},
-    {"SDL_AllocPalette", "SDL_CreatePalette"},
-    {"SDL_FreePalette", "SDL_DestroyPalette"},
-    {"SDL_MasksToPixelFormatEnum", "SDL_GetPixelFormatForMasks"},
-    {"SDL_PixelFormatEnumToMasks", "SDL_GetMasksForPixelFormat"},
-};
+  void checkTables(const ast_matchers::MatchFinder::MatchResult &Result) {
+    // Every match passed includesCheckedSDLHeader(), so the TU has a state
+    SDLTUState &TU = *SDLTUState::Current;
+    if (Result.Nodes.getNodeAs<TranslationUnitDecl>("sdl_tu")) {
+      SDLStats::charge("handler", "sdl_tu");
+      TableVisitor(*this, TU, *Result.Context).TraverseAST(*Result.Context);
+      return;
+    }
+    // The matched decls are memoized, so these lookups are hits
+    SDLDeclMemo &Memo = TU.Memo;
+    const SourceManager &SM = *Result.SourceManager;
+    if (const auto *Call = Result.Nodes.getNodeAs<CallExpr>("sdl_call")) {
+      if (const auto *Row = Memo.lookup(Call->getDirectCallee(), SM).Row)
+        EmitCallMigration(*this, Call, *Row);
+      return;
+    }
+    if (const auto *DRE = Result.Nodes.getNodeAs<DeclRefExpr>("sdl_symbol")) {
+      if (const auto *Row = Memo.lookup(DRE->getDecl(), SM).Row)
+        EmitSymbolMigration(*this, DRE->getSourceRange(), *Row);
+      return;
+    }
+    if (const auto *Loc = Result.Nodes.getNodeAs<TypeLoc>("sdl_type_loc")) {
+      const NamedDecl *Type = nullptr;
+      if (const auto *Typedef = Loc->getType()->getAs<TypedefType>())
+        Type = Typedef->getDecl();
+      else if (const auto *Record = Loc->getType()->getAs<RecordType>())
+        Type = Record->getDecl();
+      if (const auto *Row = Type ? Memo.lookup(Type, SM).Row : nullptr)
+        EmitSymbolMigration(*this, Loc->getSourceRange(), *Row);
+      return;
+    }
+    if (const auto *Call = Result.Nodes.getNodeAs<CallExpr>("sdl_rewrite")) {
+      migrateCallRewrite(Call, *Result.SourceManager,
+                         Result.Context->getLangOpts());
+      return;
+    }
+  }
 
-static const char *PixelsRemovedFuncs[] = {
-    "SDL_FreeFormat",
-    "SDL_SetPixelFormatPalette",
-    "SDL_CalculateGammaRamp",
+  const uint32_t SubsystemMask;
+  const bool Verbose;
+  const bool UseVisitor;
+  const std::string DatabasePath;
+  const MigrationDatabase *Database = nullptr;
+  const std::string StatsDirectory;
+  const std::string TraceDirectory;
+  const bool Summary;
+  const bool ReportOnly;
+  const std::string HeaderCache;
+  const bool ReplayHeaders;
+  llvm::SmallVector<std::unique_ptr<SDLSubsystemHandler>, 3> Handlers;
 };
 
-static const char *PixelsSymbolRenames[][2] = {
-    {"SDL_PIXELFORMAT_BGR444", "SDL_PIXELFORMAT_XBGR4444"},
-    {"SDL_PIXELFORMAT_BGR555", "SDL_PIXELFORMAT_XBGR1555"},
-    {"SDL_PIXELFORMAT_BGR888", "SDL_PIXELFORMAT_XBGR8888"},
-    {"SDL_PIXELFORMAT_RGB444", "SDL_PIXELFORMAT_XRGB4444"},
-    {"SDL_PIXELFORMAT_RGB555", "SDL_PIXELFORMAT_XRGB1555"},
-    {"SDL_PIXELFORMAT_RGB888", "SDL_PIXELFORMAT_XRGB8888"},
+// ---------------------------------------------------------------------------
+// SDL3AtomicCheck  (SDL_atomic.h)
+// ---------------------------------------------------------------------------
+class SDL3AtomicCheck : public SDLMigrationCheck {
+public:
+  SDL3AtomicCheck(StringRef Name, ClangTidyContext *Context)
+      : SDLMigrationCheck(Name, Context, {MigrationCheck::Atomic}) {}
 };
 
-class SDL3PixelsCheck : public ClangTidyCheck {
+// ---------------------------------------------------------------------------
+// SDL3AudioCheck  (SDL_audio.h)
+// ---------------------------------------------------------------------------
+
+// Helper: SDL3 spelling of an AUDIO_* format argument, or the text unchanged
+static StringRef MigrateAudioFormat(StringRef FormatText) {
+  const auto *Row = SDLMigrations.lookup(FormatText);
+  if (Row && Row->Check == MigrationCheck::Audio &&
+      Row->Kind == MigrationKind::SymbolRename)
+    return Row->NewName;
+  return FormatText;
+}
+
+// Helper: the calls to SDL2's SDL_NewAudioStream() held by Anchor, as
+// StatementAnchorMatcher finds them, in source order
+static llvm::SmallVector<const CallExpr *, 2>
+NewAudioStreamCalls(const Stmt *Anchor, const SourceManager &SM) {
+  llvm::SmallVector<const CallExpr *, 2> Calls;
+  SDLTUState *TU = SDLTUState::Current;
+  ForEachOutsideBlocks(Anchor, [&](const Stmt *S) {
+    const auto *Call = dyn_cast<CallExpr>(S);
+    const FunctionDecl *FD = Call ? Call->getDirectCallee() : nullptr;
+    if (FD && FD->getIdentifier() && FD->getName() == "SDL_NewAudioStream" &&
+        Call->getNumArgs() == 6 && TU &&
+        TU->Headers.isSDLHeader(SM, FD->getLocation()))
+      Calls.push_back(Call);
+  });
+  llvm::sort(Calls, [&](const CallExpr *A, const CallExpr *B) {
+    return SM.isBeforeInTranslationUnit(A->getBeginLoc(), B->getBeginLoc());
+  });
+  return Calls;
+}
+
+class SDLAudioHandler : public SDLSubsystemHandler {
 public:
-  SDL3PixelsCheck(StringRef Name, ClangTidyContext *Context)
-      : ClangTidyCheck(Name, Context) {}
+  SDLAudioHandler(ClangTidyCheck &Check, bool ReportOnly)
+      : SDLSubsystemHandler(Check, MigrationCheck::Audio, ReportOnly) {}
 
-  void registerPPCallbacks(const SourceManager &SM, Preprocessor *PP,
-                           Preprocessor *ModuleExpanderPP) override {
-    PP->addPPCallbacks(::std::make_unique<SDLIncludeCallback>(*this, SM));
+  void addMatchers(SDLMatcherSet &Matchers) const override {
+    Matchers.add(
+        callExpr(fromUserCode(), callsSDLFunction("SDL_MixAudioFormat"),
+                 hasArgument(2, expr().bind("audio_format_arg")),
+                 hasArgument(4, expr().bind("audio_volume")))
+            .bind("sdl_mix_audio_format"));
+    Matchers.add(
+        callExpr(fromUserCode(), callsSDLFunction("SDL_GetNumAudioDevices"),
+                 hasArgument(0, anyOf(integerLiteral().bind("device_type"),
+                                      anything())))
+            .bind("get_num_audio_devices"));
+
+    // The SDL_AudioSpec declarations go before the enclosing statement
+    Matchers.add(
+        StatementAnchorMatcher(
+            callExpr(callsSDLFunction("SDL_NewAudioStream"),
+                     argumentCountIs(6))
+                .bind("sdl_new_audio_stream")));
   }
 
-  void registerMatchers(ast_matchers::MatchFinder *Finder) override {
-    for (const auto &R : PixelsFuncRenames)
-      Finder->addMatcher(
-          callExpr(callee(functionDecl(hasName(R[0])))).bind(R[0]), this);
+  bool check(const ast_matchers::MatchFinder::MatchResult &Result) override {
+    if (const auto *Call =
+            Result.Nodes.getNodeAs<CallExpr>("get_num_audio_devices")) {
+      SDLStats::charge("handler", "get_num_audio_devices");
+      const auto *DeviceType =
+          Result.Nodes.getNodeAs<IntegerLiteral>("device_type");
+      if (DeviceType) {
+        std::string replacement = (DeviceType->getValue() == 0)
+                                      ? "SDL_GetAudioPlaybackDevices"
+                                      : "SDL_GetAudioRecordingDevices";
+        diag(Call->getBeginLoc(),
+             "SDL_GetNumAudioDevices() has been removed in SDL3; "
+             "use %0(&num_devices) which returns an array of device IDs")
+            << replacement;
+      } else {
+        diag(Call->getBeginLoc(),
+             "SDL_GetNumAudioDevices() has been removed in SDL3; use "
+             "SDL_GetAudioPlaybackDevices() or SDL_GetAudioRecordingDevices(), "
+             "which return an array of device IDs");
+      }
+      return true;
+    }
 
-    for (const auto &Removed : PixelsRemovedFuncs)
-      Finder->addMatcher(
-          callExpr(callee(functionDecl(hasName(Removed)))).bind(Removed), this);
+    if (const auto *Call =
+            Result.Nodes.getNodeAs<CallExpr>("sdl_mix_audio_format")) {
+      SDLStats::charge("handler", "sdl_mix_audio_format");
+      const auto *FormatArg = Result.Nodes.getNodeAs<Expr>("audio_format_arg");
+      const auto *VolumeArg = Result.Nodes.getNodeAs<Expr>("audio_volume");
+      SDLIncludeMigrator::claim(FormatArg->getSourceRange());
+      if (reportOnly()) {
+        diag(Call->getBeginLoc(), MixAudioFormatMessage);
+        return true;
+      }
 
-    for (const auto &S : PixelsSymbolRenames)
-      Finder->addMatcher(declRefExpr(to(namedDecl(hasName(S[0])))).bind(S[0]),
-                         this);
-  }
+      StringRef VolumeText = SourceText(VolumeArg, Result);
+      std::string Volume = VolumeText == "SDL_MIX_MAXVOLUME"
+                               ? "1.0f"
+                               : ("(float)" + VolumeText + " / 128").str();
 
-  void check(const ast_matchers::MatchFinder::MatchResult &Result) override {
-    for (const auto &R : PixelsFuncRenames) {
-      if (const auto *Call = Result.Nodes.getNodeAs<CallExpr>(R[0])) {
-        diag(Call->getBeginLoc(), "%0() has been renamed to %1() in SDL3")
-            << R[0] << R[1]
-            << FixItHint::CreateReplacement(Call->getCallee()->getSourceRange(),
-                                            R[1]);
-        return;
+      diag(Call->getBeginLoc(), MixAudioFormatMessage)
+          << FixItHint::CreateReplacement(Call->getCallee()->getSourceRange(),
+                                          "SDL_MixAudio")
+          << FixItHint::CreateReplacement(
+                 FormatArg->getSourceRange(),
+                 MigrateAudioFormat(SourceText(FormatArg, Result)))
+          << FixItHint::CreateReplacement(VolumeArg->getSourceRange(), Volume);
+      return true;
+    }
+    if (const auto *Call =
+            Result.Nodes.getNodeAs<CallExpr>("sdl_new_audio_stream")) {
+      SDLStats::charge("handler", "sdl_new_audio_stream");
+      if (const auto *Anchor = Result.Nodes.getNodeAs<Stmt>("anchor")) {
+        SDLIncludeMigrator::claim(Call->getSourceRange());
+        if (reportOnly()) {
+          diag(Call->getBeginLoc(), NewAudioStreamMessage);
+          return true;
+        }
+        // A statement may hold several calls; the specs of the first are
+        // srcspec / dstspec, those of the Nth srcspecN / dstspecN, and the
+        // first call's diagnostic declares them all, as one insertion
+        auto Calls = NewAudioStreamCalls(Anchor, *Result.SourceManager);
+        auto SpecSuffix = [](size_t Index) {
+          return Index ? std::to_string(Index + 1) : std::string();
+        };
+        auto Arg = [&](const CallExpr *C, unsigned Index) {
+          return Lexer::getSourceText(
+              CharSourceRange::getTokenRange(
+                  C->getArg(Index)->getSourceRange()),
+              *Result.SourceManager, Result.Context->getLangOpts());
+        };
+        size_t Index = llvm::find(Calls, Call) - Calls.begin();
+        auto Diag = diag(Call->getBeginLoc(), NewAudioStreamMessage);
+        if (Index == 0) {
+          std::string VarDecls;
+          for (size_t I = 0; I < Calls.size(); ++I) {
+            std::string Suffix = SpecSuffix(I);
+            VarDecls +=
+                (Twine("SDL_AudioSpec srcspec") + Suffix + " = {" +
+                 MigrateAudioFormat(Arg(Calls[I], 0)) + ", " +
+                 Arg(Calls[I], 1) + ", " + Arg(Calls[I], 2) +
+                 "};\n  SDL_AudioSpec dstspec" + Suffix + " = {" +
+                 MigrateAudioFormat(Arg(Calls[I], 3)) + ", " +
+                 Arg(Calls[I], 4) + ", " + Arg(Calls[I], 5) + "};\n  ")
+                    .str();
+          }
+          Diag << FixItHint::CreateInsertion(Anchor->getBeginLoc(), VarDecls);
+        }
+        std::string Suffix = SpecSuffix(Index);
+        Diag << FixItHint::CreateReplacement(
+            Call->getSourceRange(),
+            ("SDL_CreateAudioStream(&srcspec" + Suffix + ", &dstspec" +
+             Suffix + ")")
+                .str());
       }
+      return true;
     }
-    for (const auto &Removed : PixelsRemovedFuncs) {
-      if (const auto *Call = Result.Nodes.getNodeAs<CallExpr>(Removed)) {
-        diag(Call->getBeginLoc(), "%0() has been removed in SDL3") << Removed;
-        return;
+    return false;
+  }
+
+private:
+  static constexpr StringLiteral MixAudioFormatMessage =
+      "SDL_MixAudioFormat() has been removed in SDL3. Use SDL_MixAudio() "
+      "instead and change the arguments appropriately";
+  static constexpr StringLiteral NewAudioStreamMessage =
+      "SDL_NewAudioStream() has been replaced in SDL3. Use "
+      "SDL_CreateAudioStream() with SDL_AudioSpec structures";
+};
+
+class SDL3AudioCheck : public SDLMigrationCheck {
+public:
+  SDL3AudioCheck(StringRef Name, ClangTidyContext *Context)
+      : SDLMigrationCheck(Name, Context, {MigrationCheck::Audio}) {
+    addHandler<SDLAudioHandler>();
+  }
+};
+
+// ---------------------------------------------------------------------------
+// SDL3InitCheck  (SDL_init.h + error-checking patterns + endian + cpuinfo)
+// ---------------------------------------------------------------------------
+class SDLInitHandler : public SDLSubsystemHandler {
+public:
+  SDLInitHandler(ClangTidyCheck &Check, bool ReportOnly)
+      : SDLSubsystemHandler(Check, MigrationCheck::Init, ReportOnly) {}
+
+  void addMatchers(SDLMatcherSet &Matchers) const override {
+    // SDL3 functions return bool; match the SDL2 tests of an int error code
+    // wherever they are written: if / while / for conditions, ternaries,
+    // returns, initializers and assignments
+    auto ErrorCodeCall = callExpr(callee(functionDecl(hasBoolReturnRow())))
+                             .bind("sdl_error_call");
+    auto Zero = integerLiteral(equals(0));
+    auto MinusOne = unaryOperator(hasOperatorName("-"),
+                                  hasUnaryOperand(integerLiteral(equals(1))));
+
+    // f() == -1, f() < 0, f() != 0  ->  !f()
+    Matchers.add(
+        binaryOperator(fromUserCode(), hasLHS(ErrorCodeCall),
+                       anyOf(allOf(hasOperatorName("=="), hasRHS(MinusOne)),
+                             allOf(hasAnyOperatorName("<", "!="),
+                                   hasRHS(Zero))))
+            .bind("sdl_error_check_failure"));
+
+    // f() == 0, f() >= 0  ->  f()
+    Matchers.add(binaryOperator(fromUserCode(), hasLHS(ErrorCodeCall),
+                                hasAnyOperatorName("==", ">="), hasRHS(Zero))
+                     .bind("sdl_error_check_success"));
+
+    // !f()  ->  f()
+    Matchers.add(unaryOperator(fromUserCode(), hasOperatorName("!"),
+                               hasUnaryOperand(ErrorCodeCall))
+                     .bind("sdl_error_check_negation"));
+
+    // f() as a condition, true on failure  ->  !f()
+    Matchers.add(
+        mapAnyOf(ifStmt, whileStmt, doStmt, forStmt, conditionalOperator)
+            .with(fromUserCode(), hasCondition(ErrorCodeCall))
+            .bind("sdl_error_check_condition"));
+  }
+
+  bool check(const ast_matchers::MatchFinder::MatchResult &Result) override {
+    // The error-check fixes only touch the tokens around the call, so they
+    // compose with a rename of the call by another check
+    const auto *Call = Result.Nodes.getNodeAs<CallExpr>("sdl_error_call");
+    if (!Call)
+      return false;
+    const SourceManager &SM = *Result.SourceManager;
+    const LangOptions &LangOpts = Result.Context->getLangOpts();
+    // The comparison of the call's result, up to the end of BinOp
+    auto TestOf = [&](const BinaryOperator *BinOp) {
+      return CharSourceRange::getCharRange(
+          Lexer::getLocForEndOfToken(Call->getEndLoc(), 0, SM, LangOpts),
+          Lexer::getLocForEndOfToken(BinOp->getEndLoc(), 0, SM, LangOpts));
+    };
+
+    if (const auto *BinOp = Result.Nodes.getNodeAs<BinaryOperator>(
+            "sdl_error_check_failure")) {
+      SDLStats::charge("handler", "sdl_error_check_failure");
+      if (reportOnly()) {
+        diag(BinOp->getOperatorLoc(),
+             "SDL3 functions that returned a negative error now return bool; "
+             "remove the comparison and negate to indicate failure");
+        return true;
       }
+      auto Test = TestOf(BinOp);
+      diag(BinOp->getOperatorLoc(),
+           "SDL3 functions that returned a negative error now return bool; "
+           "remove '%0' and negate to indicate failure")
+          << Lexer::getSourceText(Test, SM, LangOpts).trim()
+          << FixItHint::CreateInsertion(Call->getBeginLoc(), "!")
+          << FixItHint::CreateRemoval(Test);
+      return true;
     }
-    for (const auto &S : PixelsSymbolRenames) {
-      if (const auto *DRE = Result.Nodes.getNodeAs<DeclRefExpr>(S[0])) {
-        diag(DRE->getBeginLoc(), "%0 has been renamed to %1 in SDL3")
-            << S[0] << S[1]
-            << FixItHint::CreateReplacement(DRE->getSourceRange(), S[1]);
-        return;
+
+    if (const auto *BinOp = Result.Nodes.getNodeAs<BinaryOperator>(
+            "sdl_error_check_success")) {
+      SDLStats::charge("handler", "sdl_error_check_success");
+      if (reportOnly()) {
+        diag(BinOp->getOperatorLoc(),
+             "SDL3 functions that returned 0 for success now return bool; "
+             "remove the comparison for the success branch");
+        return true;
       }
+      auto Test = TestOf(BinOp);
+      diag(BinOp->getOperatorLoc(),
+           "SDL3 functions that returned 0 for success now return bool; "
+           "remove '%0' for the success branch")
+          << Lexer::getSourceText(Test, SM, LangOpts).trim()
+          << FixItHint::CreateRemoval(Test);
+      return true;
+    }
+
+    if (const auto *Not = Result.Nodes.getNodeAs<UnaryOperator>(
+            "sdl_error_check_negation")) {
+      SDLStats::charge("handler", "sdl_error_check_negation");
+      auto Diag = diag(Not->getOperatorLoc(),
+                       "SDL3 functions that returned 0 for success now "
+                       "return bool; remove '!' for the success branch");
+      if (!reportOnly())
+        Diag << FixItHint::CreateRemoval(Not->getOperatorLoc());
+      return true;
+    }
+
+    if (Result.Nodes.getNodeAs<Stmt>("sdl_error_check_condition")) {
+      SDLStats::charge("handler", "sdl_error_check_condition");
+      auto Diag = diag(Call->getBeginLoc(),
+                       "SDL3 functions that returned non-zero on failure now "
+                       "return bool; negate the call to test for failure");
+      if (!reportOnly())
+        Diag << FixItHint::CreateInsertion(Call->getBeginLoc(), "!");
+    }
+    return true;
+  }
+};
+
+class SDL3InitCheck : public SDLMigrationCheck {
+public:
+  SDL3InitCheck(StringRef Name, ClangTidyContext *Context)
+      : SDLMigrationCheck(Name, Context, {MigrationCheck::Init}) {
+    addHandler<SDLInitHandler>();
+  }
+};
+
+// ===========================================================================
+// SDL3GamepadCheck  (SDL_gamecontroller.h -> SDL_gamepad.h)
+// ===========================================================================
+class SDL3GamepadCheck : public SDLMigrationCheck {
+public:
+  SDL3GamepadCheck(StringRef Name, ClangTidyContext *Context)
+      : SDLMigrationCheck(Name, Context, {MigrationCheck::Gamepad}) {}
+};
+
+// ===========================================================================
+// SDL3JoystickCheck  (SDL_joystick.h)
+// ===========================================================================
+class SDL3JoystickCheck : public SDLMigrationCheck {
+public:
+  SDL3JoystickCheck(StringRef Name, ClangTidyContext *Context)
+      : SDLMigrationCheck(Name, Context, {MigrationCheck::Joystick}) {}
+};
+
+// ===========================================================================
+// SDL3HapticCheck  (SDL_haptic.h)
+// ===========================================================================
+class SDL3HapticCheck : public SDLMigrationCheck {
+public:
+  SDL3HapticCheck(StringRef Name, ClangTidyContext *Context)
+      : SDLMigrationCheck(Name, Context, {MigrationCheck::Haptic}) {}
+};
+
+// ===========================================================================
+// SDL3MouseCheck  (SDL_mouse.h)
+// ===========================================================================
+class SDL3MouseCheck : public SDLMigrationCheck {
+public:
+  SDL3MouseCheck(StringRef Name, ClangTidyContext *Context)
+      : SDLMigrationCheck(Name, Context, {MigrationCheck::Mouse}) {}
+};
+
+// ===========================================================================
+// SDL3RenderCheck  (SDL_render.h)
+// ===========================================================================
+class SDL3RenderCheck : public SDLMigrationCheck {
+public:
+  SDL3RenderCheck(StringRef Name, ClangTidyContext *Context)
+      : SDLMigrationCheck(Name, Context, {MigrationCheck::Render}) {}
+};
+
+// ===========================================================================
+// SDL3MutexCheck  (SDL_mutex.h)
+// ===========================================================================
+class SDL3MutexCheck : public SDLMigrationCheck {
+public:
+  SDL3MutexCheck(StringRef Name, ClangTidyContext *Context)
+      : SDLMigrationCheck(Name, Context, {MigrationCheck::Mutex}) {}
+};
+
+// ===========================================================================
+// SDL3RectCheck  (SDL_rect.h)
+// ===========================================================================
+class SDL3RectCheck : public SDLMigrationCheck {
+public:
+  SDL3RectCheck(StringRef Name, ClangTidyContext *Context)
+      : SDLMigrationCheck(Name, Context, {MigrationCheck::Rect}) {}
+};
+
+// ===========================================================================
+// SDL3SurfaceCheck  (SDL_surface.h)
+// ===========================================================================
+class SDLSurfaceHandler : public SDLSubsystemHandler {
+public:
+  SDLSurfaceHandler(ClangTidyCheck &Check, bool ReportOnly)
+      : SDLSubsystemHandler(Check, MigrationCheck::Surface, ReportOnly) {}
+
+  void addMatchers(SDLMatcherSet &Matchers) const override {
+    // SDL_CreateRGBSurface() -> SDL_CreateSurface(), masks need converting
+    Matchers.add(
+        callExpr(fromUserCode(), callsSDLFunction("SDL_CreateRGBSurface"))
+            .bind("sdl_create_rgb_surface"));
+  }
+
+  bool check(const ast_matchers::MatchFinder::MatchResult &Result) override {
+    if (const auto *Call =
+            Result.Nodes.getNodeAs<CallExpr>("sdl_create_rgb_surface")) {
+      SDLStats::charge("handler", "sdl_create_rgb_surface");
+      diag(Call->getBeginLoc(),
+           "SDL_CreateRGBSurface() has been replaced by SDL_CreateSurface() "
+           "in SDL3; use SDL_GetPixelFormatForMasks() to convert masks to a "
+           "pixel format");
+      return true;
     }
+    return false;
+  }
+};
+
+class SDL3SurfaceCheck : public SDLMigrationCheck {
+public:
+  SDL3SurfaceCheck(StringRef Name, ClangTidyContext *Context)
+      : SDLMigrationCheck(Name, Context, {MigrationCheck::Surface}) {
+    addHandler<SDLSurfaceHandler>();
+  }
+};
+
+// ===========================================================================
+// SDL3IOStreamCheck  (SDL_rwops.h -> SDL_iostream.h)
+// ===========================================================================
+class SDL3IOStreamCheck : public SDLMigrationCheck {
+public:
+  SDL3IOStreamCheck(StringRef Name, ClangTidyContext *Context)
+      : SDLMigrationCheck(Name, Context, {MigrationCheck::IOStream}) {}
+};
+
+// ===========================================================================
+// SDL3LogCheck  (SDL_log.h)
+// ===========================================================================
+class SDL3LogCheck : public SDLMigrationCheck {
+public:
+  SDL3LogCheck(StringRef Name, ClangTidyContext *Context)
+      : SDLMigrationCheck(Name, Context, {MigrationCheck::Log}) {}
+};
+
+// ===========================================================================
+// SDL3PixelsCheck  (SDL_pixels.h)
+// ===========================================================================
+class SDL3PixelsCheck : public SDLMigrationCheck {
+public:
+  SDL3PixelsCheck(StringRef Name, ClangTidyContext *Context)
+      : SDLMigrationCheck(Name, Context, {MigrationCheck::Pixels}) {}
+};
+
+// ===========================================================================
+// SDL3AllCheck  (every subsystem above)
+// ===========================================================================
+// Migrates what all of the checks above do in one check: the table rows of
+// every subsystem share one call, one symbol and one rewrite matcher, and the
+// check owns the subsystem handlers of the checks that have any, so their
+// matchers are in its set and they report under its name. Each of those keeps
+// its own header gate.
+class SDL3AllCheck : public SDLMigrationCheck {
+public:
+  SDL3AllCheck(StringRef Name, ClangTidyContext *Context)
+      : SDLMigrationCheck(
+            Name, Context,
+            {MigrationCheck::Atomic, MigrationCheck::Audio,
+             MigrationCheck::Init, MigrationCheck::Gamepad,
+             MigrationCheck::Joystick, MigrationCheck::Haptic,
+             MigrationCheck::Mouse, MigrationCheck::Render,
+             MigrationCheck::Mutex, MigrationCheck::Rect,
+             MigrationCheck::Surface, MigrationCheck::IOStream,
+             MigrationCheck::Log, MigrationCheck::Pixels}) {
+    addHandler<SDLAudioHandler>();
+    addHandler<SDLInitHandler>();
+    addHandler<SDLSurfaceHandler>();
   }
 };
 
@@ -1865,6 +2764,8 @@ public:
     CheckFactories.registerCheck<SDL3LogCheck>("sdl3-migration-log");
     // SDL_pixels.h
     CheckFactories.registerCheck<SDL3PixelsCheck>("sdl3-migration-pixels");
+    // Every subsystem above, in one check
+    CheckFactories.registerCheck<SDL3AllCheck>("sdl3-migration-all");
   }
 };
 
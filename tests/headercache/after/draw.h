@@ -0,0 +1,4 @@
+#pragma once
+
+// Expanded by only one of the translation units including it
+#define DRAW(r, t) SDL_RenderTexture(r, t, nullptr, nullptr)
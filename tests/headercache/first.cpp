@@ -0,0 +1,6 @@
+// Includes draw.h without expanding DRAW; clang-tidy runs on it before
+// test_headercache_before.cpp, in the same process
+#include <SDL2/SDL.h>
+#include "draw.h"
+
+void clear(SDL_Renderer *renderer) { SDL_RenderClear(renderer); }
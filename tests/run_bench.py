@@ -0,0 +1,416 @@
+#!/usr/bin/env python3
+"""
+SDL3 migration plugin benchmark.
+
+Generates a synthetic translation unit that mixes SDL2 calls with a large
+amount of non-SDL code, runs clang-tidy with --enable-check-profile over it and
+reports the time spent inside the sdl3-migration-* checks (matcher evaluation
+plus check() callbacks).
+
+Pass a second plugin with --baseline to compare two builds of the plugin, e.g.
+the current tree against a build of the previous commit. --corpus templates
+generates a template-heavy TU instead, where every SDL call sits in a class
+template that is instantiated many times.
+
+--engine selects how the checks migrate their table rows (the Engine check
+option: MatchFinder matchers or one RecursiveASTVisitor walk);
+--compare-engines profiles the plugin once with each engine on the same
+corpus, reporting the visitor against the matchers.
+
+--batch N times one clang-tidy process over N small SDL2 TUs instead and
+reports the wall time per TU, which includes the per-TU setup of the checks
+(creating them, registering their matchers).
+
+Usage:  python3 run_bench.py [--baseline OLD.so | --compare-engines]
+                             [--engine matchers|visitor] [--checks FILTER]
+                             [--corpus plain|templates | --batch N]
+                             [--functions N] [--repeat R]
+                             [path/to/SDL3MigrationCheck.so]
+Report: tests/bench_report.txt  (always this name)
+"""
+
+import argparse
+import glob
+import json
+import os
+import shutil
+import subprocess
+import sys
+import tempfile
+import time
+
+from run_tests import find_plugin, get_pkg_cflags
+
+TESTS_DIR = os.path.dirname(os.path.abspath(__file__))
+REPORT_FILE = os.path.join(TESTS_DIR, "bench_report.txt")
+
+
+# ---------------------------------------------------------------------------
+# Corpus generation
+# ---------------------------------------------------------------------------
+
+# SDL2 calls sprinkled through the corpus; one of each per "SDL" function.
+SDL_SNIPPETS = [
+    "SDL_RenderCopy(renderer, tex, nullptr, nullptr);",
+    "SDL_RenderDrawLine(renderer, 0, 0, i, i);",
+    "SDL_GameControllerGetAxis(gc, SDL_CONTROLLER_AXIS_LEFTX);",
+    "SDL_JoystickGetButton(joy, 0);",
+    "SDL_FreeSurface(nullptr);",
+    "SDL_AtomicAdd(&counter, 1);",
+    "SDL_CondSignal(cond);",
+    "SDL_RWclose(rw);",
+]
+
+
+def generate_corpus(path, functions):
+    """
+    Write a TU with `functions` plain C++ functions and `functions / 8`
+    functions that use SDL2, so most of the matcher work happens on nodes
+    the plugin does not care about.
+    """
+    lines = [
+        "#include <SDL2/SDL.h>",
+        "#include <vector>",
+        "#include <string>",
+        "",
+        "struct Vec { float x, y, z; };",
+        "static float dot(const Vec &a, const Vec &b) {",
+        "  return a.x * b.x + a.y * b.y + a.z * b.z;",
+        "}",
+        "",
+    ]
+    for i in range(functions):
+        lines += [
+            f"float plain_{i}(std::vector<Vec> &v, const std::string &s) {{",
+            "  float acc = 0;",
+            "  for (size_t k = 0; k < v.size(); ++k) {",
+            "    acc += dot(v[k], v[(k + 1) % v.size()]);",
+            "    if (s.size() > k) acc -= static_cast<float>(s[k]);",
+            "  }",
+            "  return acc;",
+            "}",
+        ]
+    for i in range(max(1, functions // 8)):
+        lines += [
+            f"void sdl_{i}(SDL_Renderer *renderer, SDL_Texture *tex,",
+            "           SDL_GameController *gc, SDL_Joystick *joy,",
+            "           SDL_atomic_t &counter, SDL_cond *cond, SDL_RWops *rw) {",
+            f"  int i = {i};",
+        ]
+        lines += ["  " + snippet for snippet in SDL_SNIPPETS]
+        lines += ["}"]
+    with open(path, "w") as f:
+        f.write("\n".join(lines))
+        f.write("\n")
+
+
+def generate_template_corpus(path, functions):
+    """
+    Write a TU whose SDL calls live in class templates: `functions`
+    instantiations of a generic (non-SDL) template plus `functions / 8`
+    instantiations of a template that uses SDL2. A check that matches
+    instantiations sees every SDL call once per instantiation.
+    """
+    lines = [
+        "#include <SDL2/SDL.h>",
+        "#include <vector>",
+        "#include <string>",
+        "",
+        "template <typename T, int N> struct Accumulator {",
+        "  static T run(const std::vector<T> &v, const std::string &s) {",
+        "    T acc{};",
+        "    for (size_t k = 0; k < v.size(); ++k) {",
+        "      acc += v[k] * static_cast<T>(N);",
+        "      if (s.size() > k) acc -= static_cast<T>(s[k]);",
+        "    }",
+        "    return acc;",
+        "  }",
+        "};",
+        "",
+        "template <int N> struct Layer {",
+        "  static void draw(SDL_Renderer *renderer, SDL_Texture *tex,",
+        "                   SDL_GameController *gc, SDL_Joystick *joy,",
+        "                   SDL_atomic_t &counter, SDL_cond *cond,",
+        "                   SDL_RWops *rw) {",
+        "    int i = N;",
+    ]
+    lines += ["    " + snippet for snippet in SDL_SNIPPETS]
+    lines += ["  }", "};", ""]
+    for i in range(functions):
+        lines.append(f"float plain_{i}(const std::vector<float> &v, "
+                     f"const std::string &s) {{")
+        lines.append(f"  return Accumulator<float, {i}>::run(v, s);")
+        lines.append("}")
+    for i in range(max(1, functions // 8)):
+        lines += [
+            f"void sdl_{i}(SDL_Renderer *renderer, SDL_Texture *tex,",
+            "           SDL_GameController *gc, SDL_Joystick *joy,",
+            "           SDL_atomic_t &counter, SDL_cond *cond, SDL_RWops *rw) {",
+            f"  Layer<{i}>::draw(renderer, tex, gc, joy, counter, cond, rw);",
+            "}",
+        ]
+    with open(path, "w") as f:
+        f.write("\n".join(lines))
+        f.write("\n")
+
+
+CORPORA = {
+    "plain": generate_corpus,
+    "templates": generate_template_corpus,
+}
+
+
+def generate_batch(directory, count):
+    """Write `count` small TUs that each make one SDL2 call."""
+    paths = []
+    for i in range(count):
+        path = os.path.join(directory, f"batch_{i}.cpp")
+        with open(path, "w") as f:
+            f.write("#include <SDL2/SDL.h>\n\n")
+            f.write(f"void batch_{i}(SDL_Renderer *renderer, "
+                    "SDL_Texture *tex) {\n")
+            f.write("  SDL_RenderCopy(renderer, tex, nullptr, nullptr);\n")
+            f.write("}\n")
+        paths.append(path)
+    return paths
+
+
+# ---------------------------------------------------------------------------
+# Profiling
+# ---------------------------------------------------------------------------
+
+def engine_config(plugin, check_filter, engine):
+    """
+    --config value selecting `engine` for every check the filter enables;
+    Engine is a per-check option.
+    """
+    result = subprocess.run(
+        ["clang-tidy", f"--load={plugin}", f"--checks=-*,{check_filter}",
+         "--list-checks"],
+        capture_output=True, text=True,
+    )
+    checks = [line.strip() for line in result.stdout.splitlines()
+              if line.strip().startswith("sdl3-migration-")]
+    options = ", ".join(f"{check}.Engine: {engine}" for check in checks)
+    return f"{{CheckOptions: {{{options}}}}}"
+
+
+def profile_once(plugin, source_file, check_filter, config, sdl2_flags,
+                 profile_dir):
+    """
+    Run clang-tidy once and return {check_name: wall_seconds} for the checks
+    that match the sdl3-migration- prefix.
+    """
+    for old in glob.glob(os.path.join(profile_dir, "*.json")):
+        os.unlink(old)
+    cmd = [
+        "clang-tidy",
+        f"--load={plugin}",
+        f"--checks=-*,{check_filter}",
+        f"--config={config}",
+        "--enable-check-profile",
+        f"--store-check-profile={profile_dir}",
+        source_file,
+        "--",
+        "-std=c++17",
+    ] + sdl2_flags
+    subprocess.run(cmd, capture_output=True, text=True)
+
+    timings = {}
+    for path in glob.glob(os.path.join(profile_dir, "*.json")):
+        with open(path) as f:
+            profile = json.load(f).get("profile", {})
+        for key, value in profile.items():
+            # time.clang-tidy.<check>.wall
+            if not key.endswith(".wall"):
+                continue
+            check = key[len("time.clang-tidy."):-len(".wall")]
+            if check.startswith("sdl3-migration-"):
+                timings[check] = timings.get(check, 0.0) + value
+    return timings
+
+
+def profile_plugin(plugin, source_file, check_filter, engine, sdl2_flags,
+                   repeat):
+    """Best-of-`repeat` timings per check for one plugin build and engine."""
+    config = engine_config(plugin, check_filter, engine)
+    profile_dir = tempfile.mkdtemp()
+    best = {}
+    try:
+        for _ in range(repeat):
+            timings = profile_once(plugin, source_file, check_filter, config,
+                                   sdl2_flags, profile_dir)
+            for check, wall in timings.items():
+                best[check] = min(wall, best.get(check, wall))
+    finally:
+        shutil.rmtree(profile_dir)
+    return best
+
+
+def time_batch(plugin, sources, check_filter, engine, sdl2_flags, repeat):
+    """
+    Best-of-`repeat` wall seconds per TU of one clang-tidy process over all
+    of `sources`.
+    """
+    cmd = [
+        "clang-tidy",
+        f"--load={plugin}",
+        f"--checks=-*,{check_filter}",
+        f"--config={engine_config(plugin, check_filter, engine)}",
+    ] + sources + ["--", "-std=c++17"] + sdl2_flags
+    best = None
+    for _ in range(repeat):
+        start = time.perf_counter()
+        subprocess.run(cmd, capture_output=True, text=True)
+        wall = time.perf_counter() - start
+        best = wall if best is None else min(best, wall)
+    return best / len(sources)
+
+
+# ---------------------------------------------------------------------------
+# Reporting
+# ---------------------------------------------------------------------------
+
+def build_report(current, baseline, corpus, functions,
+                 labels=("current", "baseline")):
+    lines = []
+    sep = "=" * 66
+
+    lines.append(sep)
+    lines.append("SDL3 Migration Plugin – Benchmark Report")
+    lines.append(f"Corpus ({corpus}): {functions} plain functions, "
+                 f"{max(1, functions // 8)} SDL functions")
+    lines.append(sep)
+
+    header = f"  {'check':<32}{labels[0] + ' (s)':>14}"
+    if baseline is not None:
+        header += f"{labels[1] + ' (s)':>14}{'speedup':>10}"
+    lines.append(header)
+
+    checks = sorted(set(current) | set(baseline or {}))
+    for check in checks:
+        cur = current.get(check, 0.0)
+        row = f"  {check:<32}{cur:>14.4f}"
+        if baseline is not None:
+            base = baseline.get(check, 0.0)
+            speedup = f"{base / cur:.2f}x" if cur > 0 else "-"
+            row += f"{base:>14.4f}{speedup:>10}"
+        lines.append(row)
+
+    total = sum(current.values())
+    row = f"  {'total':<32}{total:>14.4f}"
+    if baseline is not None:
+        base_total = sum(baseline.values())
+        speedup = f"{base_total / total:.2f}x" if total > 0 else "-"
+        row += f"{base_total:>14.4f}{speedup:>10}"
+    lines.append(row)
+    lines.append(sep)
+    return "\n".join(lines)
+
+
+def build_batch_report(current, baseline, count,
+                       labels=("current", "baseline")):
+    sep = "=" * 66
+    lines = [
+        sep,
+        "SDL3 Migration Plugin – Benchmark Report",
+        f"Batch: {count} small TUs in one clang-tidy process",
+        sep,
+    ]
+    header = f"  {'':<32}{labels[0] + ' (ms)':>14}"
+    row = f"  {'wall time per TU':<32}{current * 1000:>14.2f}"
+    if baseline is not None:
+        header += f"{labels[1] + ' (ms)':>14}{'speedup':>10}"
+        speedup = f"{baseline / current:.2f}x" if current > 0 else "-"
+        row += f"{baseline * 1000:>14.2f}{speedup:>10}"
+    lines += [header, row, sep]
+    return "\n".join(lines)
+
+
+# ---------------------------------------------------------------------------
+# Entry point
+# ---------------------------------------------------------------------------
+
+def main():
+    parser = argparse.ArgumentParser(description=__doc__.splitlines()[1])
+    parser.add_argument("plugin", nargs="?", default=None)
+    parser.add_argument("--baseline", default=None,
+                        help="plugin build to compare against")
+    parser.add_argument("--engine", choices=["matchers", "visitor"],
+                        default="matchers",
+                        help="Engine option of the checks")
+    parser.add_argument("--compare-engines", action="store_true",
+                        help="profile the visitor engine against the "
+                             "matchers with the same plugin")
+    parser.add_argument("--checks",
+                        default="sdl3-migration-*,-sdl3-migration-all",
+                        help="clang-tidy check filter (the default leaves "
+                             "out sdl3-migration-all, with which the other "
+                             "checks stand down, to profile each of them)")
+    parser.add_argument("--corpus", choices=sorted(CORPORA), default="plain",
+                        help="shape of the generated translation unit")
+    parser.add_argument("--batch", type=int, default=0, metavar="N",
+                        help="time one process over N small TUs instead")
+    parser.add_argument("--functions", type=int, default=2000,
+                        help="number of non-SDL functions in the corpus")
+    parser.add_argument("--repeat", type=int, default=3,
+                        help="runs per plugin; the fastest run is reported")
+    args = parser.parse_args()
+    if args.compare_engines and args.baseline:
+        parser.error("--compare-engines and --baseline are exclusive")
+
+    plugin = args.plugin or find_plugin()
+    if not plugin:
+        print("ERROR: plugin .so not found", file=sys.stderr)
+        sys.exit(1)
+    plugin = os.path.abspath(plugin)
+
+    sdl2_flags, err = get_pkg_cflags("sdl2")
+    if sdl2_flags is None:
+        print(f"ERROR: {err}", file=sys.stderr)
+        sys.exit(1)
+
+    tmp_dir = tempfile.mkdtemp()
+    try:
+        if args.batch:
+            sources = generate_batch(tmp_dir, args.batch)
+
+            def measure(plugin, engine):
+                return time_batch(plugin, sources, args.checks, engine,
+                                  sdl2_flags, args.repeat)
+        else:
+            source_file = os.path.join(tmp_dir, "bench_corpus.cpp")
+            CORPORA[args.corpus](source_file, args.functions)
+
+            def measure(plugin, engine):
+                return profile_plugin(plugin, source_file, args.checks,
+                                      engine, sdl2_flags, args.repeat)
+
+        print(f"Plugin   : {plugin}")
+        labels = ("current", "baseline")
+        engine = "visitor" if args.compare_engines else args.engine
+        current = measure(plugin, engine)
+        baseline = None
+        if args.compare_engines:
+            labels = ("visitor", "matchers")
+            baseline = measure(plugin, "matchers")
+        elif args.baseline:
+            print(f"Baseline : {os.path.abspath(args.baseline)}")
+            baseline = measure(os.path.abspath(args.baseline), args.engine)
+    finally:
+        shutil.rmtree(tmp_dir)
+
+    if args.batch:
+        report = build_batch_report(current, baseline, args.batch, labels)
+    else:
+        report = build_report(current, baseline, args.corpus,
+                              args.functions, labels)
+    print(report)
+    with open(REPORT_FILE, "w") as f:
+        f.write(report)
+        f.write("\n")
+    print(f"\nReport written to: {REPORT_FILE}")
+
+
+if __name__ == "__main__":
+    main()
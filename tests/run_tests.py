@@ -7,6 +7,22 @@ For each test_<name>_before/after.cpp pair it runs three checks:
   2. after.cpp compiles with SDL3 headers (SDL2 include swapped to SDL3)
   3. clang-tidy with the plugin transforms before into after
 
+A before file can change how its test runs clang-tidy with comment lines
+(see read_directives):
+  // tidy-checks: FILTER     checks to enable, default sdl3-migration-<name>
+  // tidy-sdl2-dir: PATH     reach the SDL2 headers through a directory PATH,
+                             as a project vendoring SDL2 would
+  // tidy-config: YAML       passed to clang-tidy as --config
+  // tidy-expect: TEXT       must appear in clang-tidy's output; may repeat
+  // tidy-reject: TEXT       must not appear in clang-tidy's output; may repeat
+  // tidy-include: DIR       the test includes headers from DIR/before; the
+                             compile checks use DIR/before and DIR/after,
+                             clang-tidy fixes a copy of DIR/before, which must
+                             then match DIR/after
+  // tidy-also: FILE         a translation unit clang-tidy runs on first, in
+                             the same process; may repeat
+In the config, %T stands for the test's temporary directory.
+
 Usage:  python3 run_tests.py [path/to/SDL3MigrationCheck.so]
 Report: tests/test_report.txt  (always this name)
 """
@@ -61,6 +77,19 @@ def find_test_pairs():
     return pairs
 
 
+def read_directives(before):
+    """Return {key: [value, ...]} of the '// tidy-KEY: VALUE' lines of before."""
+    directives = {}
+    with open(before) as f:
+        for line in f:
+            line = line.strip()
+            if not line.startswith("// tidy-") or ":" not in line:
+                continue
+            key, value = line[len("// tidy-"):].split(":", 1)
+            directives.setdefault(key.strip(), []).append(value.strip())
+    return directives
+
+
 # ---------------------------------------------------------------------------
 # SDL flag helpers
 # ---------------------------------------------------------------------------
@@ -80,6 +109,25 @@ def get_pkg_cflags(pkg_name):
     return flags, None
 
 
+def vendored_sdl2_flags(sdl2_flags, path, tmp_dir):
+    """
+    sdl2_flags with the -I of the SDL2 headers replaced by tmp_dir/path, a
+    link to that directory, so the headers are found in a directory that is
+    not named SDL2.
+    """
+    flags = []
+    for flag in sdl2_flags:
+        if flag.startswith("-I") and os.path.basename(
+                os.path.normpath(flag[2:])) == "SDL2":
+            link = os.path.join(tmp_dir, path)
+            if not os.path.islink(link):
+                os.makedirs(os.path.dirname(link), exist_ok=True)
+                os.symlink(os.path.abspath(flag[2:]), link)
+            flag = "-I" + link
+        flags.append(flag)
+    return flags
+
+
 # ---------------------------------------------------------------------------
 # Compilation check
 # ---------------------------------------------------------------------------
@@ -117,12 +165,14 @@ def make_sdl3_copy(after_file):
 # clang-tidy transform check
 # ---------------------------------------------------------------------------
 
-def apply_clang_tidy(plugin, source_file, check_filter, sdl2_flags):
+def apply_clang_tidy(plugin, source_files, check_filter, sdl2_flags,
+                     config=None):
     """
-    Run clang-tidy --fix in-place on source_file using the migration plugin.
+    Run clang-tidy --fix in-place on source_files, in one process, using the
+    migration plugin.
     clang-tidy exits non-zero when it emits diagnostics, so we ignore the
     return code; the caller does a diff to verify correctness.
-    Returns stderr output (informational only).
+    Returns the diagnostics clang-tidy printed, stdout then stderr.
     """
     cmd = [
         "clang-tidy",
@@ -130,13 +180,13 @@ def apply_clang_tidy(plugin, source_file, check_filter, sdl2_flags):
         f"--checks=-*,{check_filter}",
         "--fix",
         "--fix-errors",
-        source_file,
+    ] + ([f"--config={config}"] if config else []) + source_files + [
         "--",
         "-std=c++17",
     ] + sdl2_flags
     print(f"Running command: {' '.join(cmd)}")
     result = subprocess.run(cmd, capture_output=True, text=True)
-    return result.stderr.strip()
+    return (result.stdout + result.stderr).strip()
 
 
 def apply_clang_format(file_path):
@@ -181,15 +231,21 @@ def run_test(name, before, after, plugin, sdl2_flags, sdl3_flags, tmp_dir):
     Returns list of (label: str, passed: bool, detail: str).
     """
     checks = []
+    directives = read_directives(before)
+    include = directives.get("include", [None])[0]
+    include_dir = os.path.join(TESTS_DIR, include) if include else None
 
     # 1. before compiles with SDL2
-    ok, err = compile_syntax_check(before, sdl2_flags)
+    ok, err = compile_syntax_check(
+        before, sdl2_flags + ([f"-I{include_dir}/before"] if include else []))
     checks.append(("before compiles with SDL2", ok, err))
 
     # 2. after compiles with SDL3
     # sdl3_copy = make_sdl3_copy(after)
     try:
-        ok, err = compile_syntax_check(after, sdl3_flags)
+        ok, err = compile_syntax_check(
+            after,
+            sdl3_flags + ([f"-I{include_dir}/after"] if include else []))
         checks.append(("after compiles with SDL3", ok, err))
     finally:
         print("finally")
@@ -200,10 +256,37 @@ def run_test(name, before, after, plugin, sdl2_flags, sdl3_flags, tmp_dir):
         checks.append(("clang-tidy transforms before → after", False, "plugin .so not found"))
         return checks
 
+    test_dir = os.path.join(tmp_dir, name)
+    os.makedirs(test_dir)
     tmp_before = os.path.join(tmp_dir, f"test_{name}_after_check.cpp")
     shutil.copy2(before, tmp_before)
-    check_filter = f"sdl3-migration-{name}"
-    apply_clang_tidy(plugin, tmp_before, check_filter, sdl2_flags)
+    check_filter = directives.get("checks", [f"sdl3-migration-{name}"])[0]
+    tidy_flags = sdl2_flags
+    if "sdl2-dir" in directives:
+        tidy_flags = vendored_sdl2_flags(sdl2_flags,
+                                         directives["sdl2-dir"][0], tmp_dir)
+    tmp_include = None
+    if include:
+        tmp_include = os.path.join(test_dir, include)
+        shutil.copytree(os.path.join(include_dir, "before"), tmp_include)
+        tidy_flags = tidy_flags + [f"-I{tmp_include}"]
+    sources = []
+    for also in directives.get("also", []):
+        sources.append(os.path.join(test_dir, os.path.basename(also)))
+        shutil.copy2(os.path.join(TESTS_DIR, also), sources[-1])
+    config = directives.get("config", [None])[0]
+    if config:
+        config = config.replace("%T", test_dir)
+    output = apply_clang_tidy(plugin, sources + [tmp_before], check_filter,
+                              tidy_flags, config)
+    for text in directives.get("expect", []):
+        found = text in output
+        checks.append((f"clang-tidy reports '{text}'", found,
+                       "" if found else output))
+    for text in directives.get("reject", []):
+        found = text in output
+        checks.append((f"clang-tidy does not report '{text}'", not found,
+                       output if found else ""))
     apply_clang_format(tmp_before)
     apply_clang_format(after)
     match, diff_text = diff_files(tmp_before, after)
@@ -215,6 +298,19 @@ def run_test(name, before, after, plugin, sdl2_flags, sdl3_flags, tmp_dir):
         os.unlink(diff_file)
     checks.append(("clang-tidy transforms before → after", match, diff_text))
 
+    if include:
+        headers = sorted(
+            os.path.relpath(os.path.join(root, f), tmp_include)
+            for root, _, files in os.walk(tmp_include) for f in files)
+        for header in headers:
+            fixed = os.path.join(tmp_include, header)
+            expected = os.path.join(include_dir, "after", header)
+            apply_clang_format(fixed)
+            apply_clang_format(expected)
+            match, diff_text = diff_files(fixed, expected)
+            checks.append((f"clang-tidy transforms {include}/{header}", match,
+                           diff_text))
+
     return checks
 
 
@@ -0,0 +1,6 @@
+#pragma once
+
+// Stands for SDL3's SDL_mouse.h, vendored into a directory of another name
+extern "C" {
+bool SDL_CaptureMouse(bool enabled);
+}
@@ -0,0 +1,5 @@
+#pragma once
+
+#define SDL_MAJOR_VERSION   3
+#define SDL_MINOR_VERSION   2
+#define SDL_MICRO_VERSION   0
@@ -0,0 +1,7 @@
+#pragma once
+
+// Stands for SDL3's own SDL_render.h, in its SDL3 include directory
+extern "C" {
+typedef struct SDL_Renderer SDL_Renderer;
+bool SDL_RenderClear(SDL_Renderer *renderer);
+}
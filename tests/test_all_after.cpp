@@ -0,0 +1,26 @@
+#include <SDL3/SDL.h>
+
+// One subsystem per block; sdl3-migration-all migrates them in one pass
+int main() {
+    if (!SDL_Init(SDL_INIT_VIDEO | SDL_INIT_AUDIO))
+        return 1;
+
+    SDL_AtomicInt counter;
+    SDL_SetAtomicInt(&counter, 0);
+
+    SDL_Mutex *mutex = SDL_CreateMutex();
+    SDL_LockMutex(mutex);
+    SDL_UnlockMutex(mutex);
+    SDL_DestroyMutex(mutex);
+
+    SDL_Gamepad *pad = SDL_OpenGamepad(0);
+    SDL_CloseGamepad(pad);
+
+    SDL_Surface *surface = SDL_CreateSurface(64, 64, SDL_PIXELFORMAT_RGBA8888);
+    SDL_DestroySurface(surface);
+
+    SDL_AudioDeviceID dev = 0;
+    SDL_ResumeAudioDevice(dev);
+
+    SDL_Quit();
+}
@@ -11,6 +11,25 @@ int main() {
     SDL_ClearAudioStream(stream);
     SDL_DestroyAudioStream(stream);
 
+    // In a nested block: anchored once, by the innermost statement
+    {
+        SDL_AudioSpec srcspec = {SDL_AUDIO_S16LE, 1, 22050};
+        SDL_AudioSpec dstspec = {SDL_AUDIO_S16LE, 1, 44100};
+        SDL_AudioStream *in = SDL_CreateAudioStream(&srcspec, &dstspec);
+        SDL_DestroyAudioStream(in);
+    }
+    // Two calls in one statement: both migrated, with their own specs
+    {
+        SDL_AudioSpec srcspec = {SDL_AUDIO_F32LE, 1, 48000};
+        SDL_AudioSpec dstspec = {SDL_AUDIO_S16LE, 1, 48000};
+        SDL_AudioSpec srcspec2 = {SDL_AUDIO_F32LE, 1, 48000};
+        SDL_AudioSpec dstspec2 = {SDL_AUDIO_S16LE, 1, 44100};
+        SDL_AudioStream *left = SDL_CreateAudioStream(&srcspec, &dstspec),
+                        *right = SDL_CreateAudioStream(&srcspec2, &dstspec2);
+        SDL_DestroyAudioStream(left);
+        SDL_DestroyAudioStream(right);
+    }
+
     SDL_AudioSpec spec;
     Uint8 *buf = nullptr;
     Uint32 len = 0;
@@ -18,6 +37,10 @@ int main() {
     SDL_LoadWAV_IO(SDL_IOFromFile("sound.wav", "rb"), 1, &spec, &buf, &len);
     SDL_free(buf);
 
+    SDL_AudioDeviceID dev = 0;
+    SDL_ResumeAudioDevice(dev);
+    SDL_PauseAudioDevice(dev);
+
     SDL_MixAudio(nullptr, nullptr, SDL_AUDIO_S16LE, 0, 1.0f);
     SDL_MixAudio(nullptr, nullptr, SDL_AUDIO_S16LE, 0, (float)64 / 128);
 }
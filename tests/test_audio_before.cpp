@@ -10,12 +10,32 @@ int main() {
   SDL_AudioStreamClear(stream);
   SDL_FreeAudioStream(stream);
 
+  // In a nested block: anchored once, by the innermost statement
+  {
+    SDL_AudioStream *in =
+        SDL_NewAudioStream(AUDIO_S16, 1, 22050, AUDIO_S16, 1, 44100);
+    SDL_FreeAudioStream(in);
+  }
+  // Two calls in one statement: both migrated, with their own specs
+  {
+    SDL_AudioStream *left = SDL_NewAudioStream(AUDIO_F32, 1, 48000,
+                                               AUDIO_S16, 1, 48000),
+                    *right = SDL_NewAudioStream(AUDIO_F32, 1, 48000,
+                                                AUDIO_S16, 1, 44100);
+    SDL_FreeAudioStream(left);
+    SDL_FreeAudioStream(right);
+  }
+
   SDL_AudioSpec spec;
   Uint8 *buf = nullptr;
   Uint32 len = 0;
   SDL_LoadWAV_RW(SDL_RWFromFile("sound.wav", "rb"), 1, &spec, &buf, &len);
   SDL_FreeWAV(buf);
 
+  SDL_AudioDeviceID dev = 0;
+  SDL_PauseAudioDevice(dev, 0);
+  SDL_PauseAudioDevice(dev, 1);
+
   SDL_MixAudioFormat(nullptr, nullptr, AUDIO_S16, 0, SDL_MIX_MAXVOLUME);
   SDL_MixAudioFormat(nullptr, nullptr, AUDIO_S16, 0, 64);
 }
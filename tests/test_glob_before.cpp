@@ -0,0 +1,36 @@
+// tidy-checks: sdl3-migration-*
+// tidy-expect: [sdl3-migration-all]
+// tidy-reject: [sdl3-migration-init]
+// tidy-reject: [sdl3-migration-atomic]
+// tidy-reject: [sdl3-migration-mutex]
+// tidy-reject: [sdl3-migration-gamepad]
+// tidy-reject: [sdl3-migration-surface]
+// tidy-reject: [sdl3-migration-audio]
+#include <SDL2/SDL.h>
+
+// The glob enables sdl3-migration-all along with the per-subsystem checks,
+// which stand down: each migration is reported and fixed once
+int main() {
+    if (SDL_Init(SDL_INIT_VIDEO | SDL_INIT_AUDIO) < 0)
+        return 1;
+
+    SDL_atomic_t counter;
+    SDL_AtomicSet(&counter, 0);
+
+    SDL_mutex *mutex = SDL_CreateMutex();
+    SDL_LockMutex(mutex);
+    SDL_UnlockMutex(mutex);
+    SDL_DestroyMutex(mutex);
+
+    SDL_GameController *pad = SDL_GameControllerOpen(0);
+    SDL_GameControllerClose(pad);
+
+    SDL_Surface *surface = SDL_CreateRGBSurfaceWithFormat(0, 64, 64, 32,
+                                                           SDL_PIXELFORMAT_RGBA8888);
+    SDL_FreeSurface(surface);
+
+    SDL_AudioDeviceID dev = 0;
+    SDL_PauseAudioDevice(dev, 0);
+
+    SDL_Quit();
+}
@@ -0,0 +1,14 @@
+// tidy-checks: sdl3-migration-render
+// tidy-config: {HeaderFilterRegex: 'headercache', CheckOptions: {HeaderCache: '%T/records'}}
+// tidy-include: headercache
+// tidy-also: headercache/first.cpp
+// Only this translation unit expands DRAW, after the first one has analyzed
+// draw.h; the definition must be fixed all the same
+#include <SDL2/SDL.h>
+#include "draw.h"
+
+int main() {
+  SDL_Renderer *renderer = nullptr;
+  SDL_Texture *tex = nullptr;
+  DRAW(renderer, tex);
+}
@@ -0,0 +1,24 @@
+#include <SDL3/SDL.h>
+
+static bool start_video() {
+    return SDL_Init(SDL_INIT_VIDEO);
+}
+
+int main() {
+    if (!SDL_Init(SDL_INIT_VIDEO))
+        return 1;
+    if (!SDL_InitSubSystem(SDL_INIT_AUDIO))
+        return 1;
+    while (!SDL_InitSubSystem(SDL_INIT_EVENTS))
+        SDL_Delay(10);
+    bool joystick_ok = SDL_InitSubSystem(SDL_INIT_JOYSTICK);
+    const char *haptic = !SDL_InitSubSystem(SDL_INIT_HAPTIC) ? "failed" : "ok";
+    if (SDL_InitSubSystem(SDL_INIT_SENSOR))
+        start_video();
+
+    // Not an error code: only renamed
+    if (SDL_GetNumLogicalCPUCores() > 1)
+        return 0;
+
+    SDL_Quit();
+}
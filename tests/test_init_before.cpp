@@ -0,0 +1,24 @@
+#include <SDL2/SDL.h>
+
+static bool start_video() {
+    return SDL_Init(SDL_INIT_VIDEO) == 0;
+}
+
+int main() {
+    if (SDL_Init(SDL_INIT_VIDEO) < 0)
+        return 1;
+    if (SDL_InitSubSystem(SDL_INIT_AUDIO) == -1)
+        return 1;
+    while (SDL_InitSubSystem(SDL_INIT_EVENTS) != 0)
+        SDL_Delay(10);
+    bool joystick_ok = SDL_InitSubSystem(SDL_INIT_JOYSTICK) >= 0;
+    const char *haptic = SDL_InitSubSystem(SDL_INIT_HAPTIC) ? "failed" : "ok";
+    if (!SDL_InitSubSystem(SDL_INIT_SENSOR))
+        start_video();
+
+    // Not an error code: only renamed
+    if (SDL_GetCPUCount() > 1)
+        return 0;
+
+    SDL_Quit();
+}
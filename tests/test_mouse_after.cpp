@@ -10,4 +10,7 @@ int main() {
 
     SDL_Cursor *resize = SDL_CreateSystemCursor(SDL_SYSTEM_CURSOR_MOVE);
     SDL_DestroyCursor(resize);
+
+    Uint32 buttons = SDL_GetMouseState(nullptr, nullptr);
+    bool left = (buttons & SDL_BUTTON_MASK(SDL_BUTTON_LEFT)) != 0;
 }
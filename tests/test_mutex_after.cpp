@@ -1,5 +1,16 @@
 #include <SDL3/SDL.h>
 
+// Instantiated twice; the call is migrated once, where it is written
+template <typename T> void signal_all(T waiters, SDL_Condition *cond) {
+    for (int i = 0; i < waiters; ++i)
+        SDL_SignalCondition(cond);
+}
+
+struct Workers {
+    SDL_Mutex *lock;
+    SDL_Condition *ready;
+};
+
 int main() {
     SDL_Mutex *mutex = SDL_CreateMutex();
     SDL_LockMutex(mutex);
@@ -20,4 +31,10 @@ int main() {
     SDL_SignalSemaphore(sem);
     Uint32 val = SDL_GetSemaphoreValue(sem);
     SDL_DestroySemaphore(sem);
+
+    signal_all(2, cond);
+    signal_all(2L, cond);
+
+    Workers workers = {mutex, cond};
+    size_t size = sizeof(SDL_Semaphore *);
 }
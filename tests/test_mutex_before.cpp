@@ -1,5 +1,16 @@
 #include <SDL2/SDL.h>
 
+// Instantiated twice; the call is migrated once, where it is written
+template <typename T> void signal_all(T waiters, SDL_cond *cond) {
+    for (int i = 0; i < waiters; ++i)
+        SDL_CondSignal(cond);
+}
+
+struct Workers {
+    SDL_mutex *lock;
+    SDL_cond *ready;
+};
+
 int main(){
     SDL_mutex *mutex = SDL_CreateMutex();
     SDL_LockMutex(mutex);
@@ -20,4 +31,10 @@ int main(){
     SDL_SemPost(sem);
     Uint32 val = SDL_SemValue(sem);
     SDL_DestroySemaphore(sem);
+
+    signal_all(2, cond);
+    signal_all(2L, cond);
+
+    Workers workers = {mutex, cond};
+    size_t size = sizeof(SDL_sem *);
 }
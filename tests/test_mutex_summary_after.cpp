@@ -0,0 +1,19 @@
+// tidy-checks: sdl3-migration-mutex
+// tidy-config: {CheckOptions: {Summary: true}}
+// tidy-expect: SDL_cond has been renamed to SDL_Condition in SDL3, at 2 sites
+// tidy-expect: SDL_SignalCondition() in SDL3, at 2 sites
+#include <SDL3/SDL.h>
+
+// Instantiated twice; each spelling counts as one site of the summary
+template <typename T> void signal_all(T waiters, SDL_Condition *cond) {
+    for (int i = 0; i < waiters; ++i)
+        SDL_SignalCondition(cond);
+}
+
+int main() {
+    SDL_Condition *cond = SDL_CreateCondition();
+    SDL_SignalCondition(cond);
+    signal_all(2, cond);
+    signal_all(2L, cond);
+    SDL_DestroyCondition(cond);
+}
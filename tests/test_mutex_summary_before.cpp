@@ -0,0 +1,19 @@
+// tidy-checks: sdl3-migration-mutex
+// tidy-config: {CheckOptions: {Summary: true}}
+// tidy-expect: SDL_cond has been renamed to SDL_Condition in SDL3, at 2 sites
+// tidy-expect: SDL_SignalCondition() in SDL3, at 2 sites
+#include <SDL2/SDL.h>
+
+// Instantiated twice; each spelling counts as one site of the summary
+template <typename T> void signal_all(T waiters, SDL_cond *cond) {
+    for (int i = 0; i < waiters; ++i)
+        SDL_CondSignal(cond);
+}
+
+int main() {
+    SDL_cond *cond = SDL_CreateCond();
+    SDL_CondSignal(cond);
+    signal_all(2, cond);
+    signal_all(2L, cond);
+    SDL_DestroyCond(cond);
+}
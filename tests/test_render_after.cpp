@@ -1,6 +1,14 @@
 #include <SDL3/SDL.h>
 #include <SDL3/SDL_render.h>
 
+// Not SDL's: must not be rewritten
+namespace engine {
+static void SDL_RenderFlush(SDL_Renderer *) {}
+} // namespace engine
+
+// Migrated once, in the definition, however often it is expanded
+#define DRAW_TEXTURE(r, t) SDL_RenderTexture(r, t, nullptr, nullptr)
+
 int main() {
     SDL_Window *window = SDL_CreateWindow("Hello World", 640, 480, 0);
     SDL_Renderer *renderer = SDL_GetRenderer(window);
@@ -14,6 +22,8 @@ int main() {
         SDL_CreateTexture(renderer, SDL_PIXELFORMAT_RGBA8888, SDL_TEXTUREACCESS_TARGET, 1024, 768);
     SDL_RenderTexture(renderer, tex, nullptr, nullptr);
     SDL_RenderTextureRotated(renderer, tex, nullptr, nullptr, 0.0, nullptr, SDL_FLIP_NONE);
+    DRAW_TEXTURE(renderer, tex);
+    DRAW_TEXTURE(renderer, tex);
 
     // State management
     SDL_SetRenderViewport(renderer, nullptr);
@@ -29,4 +39,5 @@ int main() {
 
     int w, h;
     SDL_GetCurrentRenderOutputSize(renderer, &w, &h);
+    engine::SDL_RenderFlush(renderer);
 }
@@ -1,5 +1,14 @@
 #include <SDL2/SDL.h>
 #include <SDL2/SDL_video.h>
+
+// Not SDL's: must not be rewritten
+namespace engine {
+static void SDL_RenderFlush(SDL_Renderer *) {}
+} // namespace engine
+
+// Migrated once, in the definition, however often it is expanded
+#define DRAW_TEXTURE(r, t) SDL_RenderCopy(r, t, nullptr, nullptr)
+
 int main() {
   SDL_Window *window = SDL_CreateWindow("Hello World", 0, 0, 640, 480, 0);
   SDL_Renderer *renderer = SDL_GetRenderer(window);
@@ -14,6 +23,8 @@ int main() {
   SDL_RenderCopy(renderer, tex, nullptr, nullptr);
   SDL_RenderCopyEx(renderer, tex, nullptr, nullptr, 0.0, nullptr,
                    SDL_FLIP_NONE);
+  DRAW_TEXTURE(renderer, tex);
+  DRAW_TEXTURE(renderer, tex);
 
   SDL_RenderSetViewport(renderer, nullptr);
   SDL_RenderGetViewport(renderer, nullptr);
@@ -28,4 +39,5 @@ int main() {
 
   int w, h;
   SDL_GetRendererOutputSize(renderer, &w, &h);
+  engine::SDL_RenderFlush(renderer);
 }
@@ -0,0 +1,14 @@
+// tidy-checks: sdl3-migration-init,sdl3-migration-render,sdl3-migration-mouse
+// tidy-include: sdl3headers
+// Code already moved to SDL3, whose headers have the names of SDL2's: the
+// bool results must not be taken for SDL2 error codes
+#include "SDL3/SDL_render.h"
+#include "sdl/SDL_mouse.h"
+
+int main() {
+  SDL_Renderer *renderer = nullptr;
+  if (!SDL_RenderClear(renderer))
+    return 1;
+  if (!SDL_CaptureMouse(true))
+    return 1;
+}
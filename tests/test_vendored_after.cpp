@@ -0,0 +1,11 @@
+// tidy-checks: sdl3-migration-render
+// tidy-sdl2-dir: third_party/sdl/include
+// SDL2 found through a directory that is not named SDL2
+#include <SDL3/SDL.h>
+
+int main() {
+    SDL_Window *window = SDL_CreateWindow("Hello World", 640, 480, 0);
+    SDL_Renderer *renderer = SDL_GetRenderer(window);
+    SDL_RenderLine(renderer, 0, 0, 100, 100);
+    SDL_SetRenderVSync(renderer, 1);
+}
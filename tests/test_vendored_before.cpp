@@ -0,0 +1,11 @@
+// tidy-checks: sdl3-migration-render
+// tidy-sdl2-dir: third_party/sdl/include
+// SDL2 found through a directory that is not named SDL2
+#include <SDL.h>
+
+int main() {
+  SDL_Window *window = SDL_CreateWindow("Hello World", 0, 0, 640, 480, 0);
+  SDL_Renderer *renderer = SDL_GetRenderer(window);
+  SDL_RenderDrawLine(renderer, 0, 0, 100, 100);
+  SDL_RenderSetVSync(renderer, 1);
+}
@@ -0,0 +1,106 @@
+#!/usr/bin/env python3
+"""
+Sum the migration stats of a clang-tidy run.
+
+With the StatsDirectory check option set, every translation unit writes one
+JSON file of hit counts and check() time per migration table row and
+subsystem handler into that directory. This script adds them up across the
+run and prints the rows and handlers by total time. With --data it also lists
+the rows of a migration data file (SDL3Migrations.txt, or the source of a
+migration database) that no translation unit hit.
+
+Usage:  python3 aggregate_migration_stats.py STATS_DIR [--data FILE]
+                                             [--top N] [--json OUTPUT]
+"""
+
+import argparse
+import glob
+import json
+import os
+import sys
+
+from gen_migration_tables import parse
+
+# Row kinds of gen_migration_tables.py as the stats name them; "bool" rows are
+# counted by the handlers of sdl3-migration-init instead
+STATS_KINDS = {
+    "FunctionRename": "function",
+    "RemovedFunction": "removed",
+    "SymbolRename": "symbol",
+    "TypeRename": "type",
+    "CallRewrite": "rewrite",
+}
+
+
+def aggregate(stats_dir):
+    """Return ({(check, kind, name): [hits, ns, files]}, number of files)."""
+    totals = {}
+    paths = glob.glob(os.path.join(stats_dir, "*.json"))
+    for path in paths:
+        with open(path) as f:
+            counters = json.load(f).get("counters", [])
+        for c in counters:
+            total = totals.setdefault((c["check"], c["kind"], c["name"]),
+                                      [0, 0, 0])
+            total[0] += c["hits"]
+            total[1] += c["ns"]
+            total[2] += 1
+    return totals, len(paths)
+
+
+def dead_rows(data_file, totals):
+    """Rows of data_file without a hit, as (kind, name), in file order."""
+    hit = {(kind, name) for _, kind, name in totals}
+    dead = []
+    for _, entries in parse(data_file):
+        for e in entries:
+            kind = STATS_KINDS.get(e.kind)
+            if kind and (kind, e.old) not in hit and (kind, e.old) not in dead:
+                dead.append((kind, e.old))
+    return dead
+
+
+def main():
+    parser = argparse.ArgumentParser(description=__doc__.splitlines()[1])
+    parser.add_argument("stats_dir")
+    parser.add_argument("--data", default=None,
+                        help="migration data file whose unhit rows to list")
+    parser.add_argument("--top", type=int, default=30,
+                        help="rows and handlers to print, 0 for all")
+    parser.add_argument("--json", default=None,
+                        help="also write the totals to this file")
+    args = parser.parse_args()
+
+    totals, files = aggregate(args.stats_dir)
+    if not files:
+        sys.exit(f"error: no stats files in {args.stats_dir}")
+
+    ranked = sorted(totals.items(), key=lambda item: item[1][1], reverse=True)
+    print(f"{files} translation units, {len(totals)} rows and handlers hit")
+    print(f"  {'check':<26}{'kind':<10}{'name':<36}{'hits':>8}{'ms':>10}"
+          f"{'TUs':>6}")
+    for (check, kind, name), (hits, ns, tus) in ranked[:args.top or None]:
+        print(f"  {check:<26}{kind:<10}{name:<36}{hits:>8}"
+              f"{ns / 1e6:>10.3f}{tus:>6}")
+
+    dead = dead_rows(args.data, totals) if args.data else []
+    if args.data:
+        print(f"\n{len(dead)} rows of {args.data} never hit")
+        for kind, name in dead:
+            print(f"  {kind:<10}{name}")
+
+    if args.json:
+        with open(args.json, "w") as f:
+            json.dump({
+                "files": files,
+                "counters": [
+                    {"check": check, "kind": kind, "name": name,
+                     "hits": hits, "ns": ns, "files": tus}
+                    for (check, kind, name), (hits, ns, tus) in ranked
+                ],
+                "dead": [{"kind": kind, "name": name} for kind, name in dead],
+            }, f, indent=2)
+
+
+if __name__ == "__main__":
+    main()
@@ -0,0 +1,88 @@
+#!/usr/bin/env python3
+"""
+Compile a migration database for the MigrationDatabase check option.
+
+The source uses the format of SDL3Migrations.txt: `header` lines and
+`[Section]` headings naming the check that reports the rows below them, and
+`function`, `removed`, `symbol` and `type` rows (`bool` and `rewrite` rows
+are only read from SDL3Migrations.txt). A row applies to names declared in an
+SDL2 header or in a file named as its `header` line, so the database can also
+rename the functions and types of a project's own wrapper headers.
+
+The output is the binary file MigrationDatabase in SDL3MigrationCheck.cpp
+maps, all integers little endian:
+    header   "SDL3MDB\\0", version, entry count, header count, string bytes
+    entries  check, kind, then (offset, size) of header, old, new and note,
+             in the slots of the same perfect hash as gen_migration_tables.py
+    seeds    one int32 per slot
+    headers  (offset, size) of the name and the mask of the checks owning
+             names it declares, sorted by name
+    strings  every string once, sorted
+The layout must stay in sync with MigrationDatabase.
+
+Usage:  python3 compile_migration_db.py SOURCE.txt OUTPUT.sdldb
+"""
+
+import struct
+import sys
+
+from gen_migration_tables import build_perfect_hash, parse
+
+# 2: the seeds are for the finalized MigrationHash()
+VERSION = 2
+
+# Order of enum class MigrationCheck / MigrationKind in SDL3MigrationCheck.cpp
+CHECKS = ["Atomic", "Audio", "Init", "Gamepad", "Joystick", "Haptic", "Mouse",
+          "Render", "Mutex", "Rect", "Surface", "IOStream", "Log", "Pixels"]
+KINDS = ["FunctionRename", "RemovedFunction", "SymbolRename", "TypeRename"]
+
+
+def main():
+    if len(sys.argv) != 3:
+        sys.exit(__doc__.strip().splitlines()[-1])
+    source, output = sys.argv[1], sys.argv[2]
+
+    entries = []
+    for section, rows in parse(source):
+        if section not in CHECKS:
+            sys.exit(f"{source}: error: unknown check [{section}]")
+        for e in rows:
+            if e.kind not in KINDS:
+                sys.exit(f"{source}: error: '{e.old}': only function, "
+                         "removed, symbol and type rows go in a database")
+            entries.append(e)
+    slots, seeds = build_perfect_hash(entries)
+
+    masks = {}
+    for e in entries:
+        masks[e.header] = masks.get(e.header, 0) | 1 << CHECKS.index(e.check)
+
+    texts = sorted({t for e in entries
+                    for t in (e.header, e.old, e.new, e.note)})
+    offsets, blob = {}, bytearray()
+    for text in texts:
+        offsets[text] = len(blob)
+        blob += text.encode()
+
+    def string(text):
+        return (offsets[text], len(text.encode()))
+
+    data = bytearray(struct.pack("<8s4I", b"SDL3MDB\0", VERSION, len(slots),
+                                 len(masks), len(blob)))
+    for e in slots:
+        data += struct.pack("<2I8I", CHECKS.index(e.check),
+                            KINDS.index(e.kind), *string(e.header),
+                            *string(e.old), *string(e.new), *string(e.note))
+    data += struct.pack(f"<{len(seeds)}i", *seeds)
+    for header in sorted(masks, key=str.encode):
+        data += struct.pack("<3I", *string(header), masks[header])
+    data += blob
+
+    with open(output, "wb") as f:
+        f.write(data)
+    print(f"{output}: {len(slots)} entries, {len(masks)} headers, "
+          f"{len(data)} bytes")
+
+
+if __name__ == "__main__":
+    main()
@@ -0,0 +1,376 @@
+#!/usr/bin/env python3
+"""
+Generate SDL3MigrationTables.inc from SDL3Migrations.txt.
+
+All rename and removal rows of the data file go into one constexpr
+MigrationRegistry, SDLMigrations: a minimal perfect hash (hash-and-displace)
+over every SDL2 name, so a lookup is two hashes, one string compare and no
+allocation, however many rows the registry has. Each entry records the check
+owning it (its [Section]); a name may only be listed once.
+
+"bool" rows (functions whose int error code became bool) go into a second
+registry of the same shape, SDLBoolReturns, where again each name is listed
+once; a function may be in both.
+
+"rewrite" rows are call templates, e.g.
+    rewrite SDL_PauseAudioDevice($0,0) SDL_ResumeAudioDevice($0) MESSAGE
+They are compiled here into flat tables of argument patterns ($N or an
+integer literal) and replacement pieces (text followed by the source of one
+argument), keyed by a third perfect hash, SDLCallRewrites. A function may
+have several templates; the first whose arguments match is applied.
+
+A fourth perfect hash, SDLHeaderChecks, maps each SDL2 header of the data
+file to the mask of the checks owning rows declared in it, so a check can tell
+from an #include alone whether the TU can use anything it migrates.
+
+The hash must stay in sync with MigrationHash() in SDL3MigrationCheck.cpp.
+
+Usage:  python3 gen_migration_tables.py SDL3Migrations.txt OUTPUT.inc
+"""
+
+import os
+import re
+import sys
+
+KINDS = {
+    "function": "FunctionRename",
+    "removed": "RemovedFunction",
+    "symbol": "SymbolRename",
+    "type": "TypeRename",
+    "bool": "BoolReturn",
+    "rewrite": "CallRewrite",
+}
+
+CALL_RE = re.compile(r"^(\w+)\((.*)\)$")
+ARG_RE = re.compile(r"\$(\d+)")
+
+# Give up on a bucket after this many seeds; only reachable with a broken
+# hash, real tables need a handful.
+MAX_SEED = 1 << 20
+
+
+# ---------------------------------------------------------------------------
+# Parsing
+# ---------------------------------------------------------------------------
+
+class Entry:
+    def __init__(self, check, kind, header, old, new, note):
+        self.check = check
+        self.kind = kind
+        self.header = header
+        self.old = old
+        self.new = new
+        self.note = note
+        self.args = []     # rewrite rows: None for $N, else an int literal
+        self.pieces = []   # rewrite rows: [(text, arg index or -1)]
+
+
+def fail(path, line_no, message):
+    sys.exit(f"{path}:{line_no}: error: {message}")
+
+
+def parse_rewrite(path, line_no, pattern, replacement, message):
+    """Return (name, args, pieces) of a 'rewrite' row."""
+    match = CALL_RE.match(pattern)
+    if not match:
+        fail(path, line_no, f"bad call pattern '{pattern}'")
+    name, params = match.group(1), match.group(2)
+    args = []
+    for index, param in enumerate(params.split(",") if params else []):
+        if param == f"${index}":
+            args.append(None)
+        elif param.isdigit():
+            args.append(int(param))
+        else:
+            fail(path, line_no,
+                 f"argument {index} must be '${index}' or an integer literal")
+    pieces = []
+    text = replacement.replace(",", ", ")
+    start = 0
+    for ref in ARG_RE.finditer(text):
+        if int(ref.group(1)) >= len(args):
+            fail(path, line_no, f"'{ref.group(0)}' is not an argument")
+        pieces.append((text[start:ref.start()], int(ref.group(1))))
+        start = ref.end()
+    if start < len(text):
+        pieces.append((text[start:], -1))
+    if "%" in message:
+        fail(path, line_no, "'%' is not allowed in a rewrite message")
+    return name, args, pieces
+
+
+def parse(path):
+    """Return [(section, [Entry])] in file order."""
+    sections = []
+    header = None
+    seen = {}
+    with open(path) as f:
+        for line_no, raw in enumerate(f, 1):
+            line = raw.strip()
+            if not line or line.startswith("#"):
+                continue
+            if line.startswith("["):
+                if not line.endswith("]") or not line[1:-1].isidentifier():
+                    fail(path, line_no, f"bad section '{line}'")
+                sections.append((line[1:-1], []))
+                header = None
+                continue
+            fields = line.split(None, 3)
+            if fields[0] == "header":
+                if len(fields) != 2:
+                    fail(path, line_no, "expected 'header FILE'")
+                header = fields[1]
+                continue
+            if not sections:
+                fail(path, line_no, "row outside of a [Section]")
+            if fields[0] not in KINDS:
+                fail(path, line_no, f"unknown kind '{fields[0]}'")
+            if fields[0] == "bool":
+                if len(fields) != 2:
+                    fail(path, line_no, "expected 'bool OLD'")
+                fields.append("-")
+            if fields[0] == "rewrite":
+                if len(fields) != 4:
+                    fail(path, line_no,
+                         "expected 'rewrite OLD(ARGS) NEW(ARGS) MESSAGE'")
+                if header is None:
+                    fail(path, line_no, "row before any 'header' line")
+                old, args, pieces = parse_rewrite(path, line_no, *fields[1:])
+                key = (False, old)
+                if key in seen and (seen[key][1] != "rewrite" or
+                                    seen[key][2] != sections[-1][0]):
+                    fail(path, line_no,
+                         f"'{old}' is already listed on line {seen[key][0]}")
+                seen.setdefault(key, (line_no, "rewrite", sections[-1][0]))
+                entry = Entry(sections[-1][0], KINDS["rewrite"], header, old,
+                              "", fields[3])
+                entry.args, entry.pieces = args, pieces
+                sections[-1][1].append(entry)
+                continue
+            if len(fields) < 3:
+                fail(path, line_no, "expected 'KIND OLD NEW [NOTE]'")
+            if header is None:
+                fail(path, line_no, "row before any 'header' line")
+            kind, old, new = fields[0], fields[1], fields[2]
+            note = fields[3] if len(fields) > 3 else ""
+            if (kind in ("removed", "bool")) != (new == "-"):
+                fail(path, line_no, "NEW is '-' exactly for removed rows")
+            key = (kind == "bool", old)
+            if key in seen:
+                fail(path, line_no,
+                     f"'{old}' is already listed on line {seen[key][0]}")
+            seen[key] = (line_no, kind, sections[-1][0])
+            sections[-1][1].append(
+                Entry(sections[-1][0], KINDS[kind], header, old,
+                      "" if new == "-" else new, note))
+    for name, entries in sections:
+        if not entries:
+            sys.exit(f"{path}: error: section [{name}] is empty")
+    return sections
+
+
+# ---------------------------------------------------------------------------
+# Perfect hashing
+# ---------------------------------------------------------------------------
+
+def migration_hash(seed, name):
+    """32-bit FNV-1a of the name, mixed with the seed by the murmur3
+    finalizer."""
+    h = 2166136261
+    for byte in name.encode():
+        h = ((h ^ byte) * 16777619) & 0xFFFFFFFF
+    h ^= (seed * 0x9E3779B9) & 0xFFFFFFFF
+    h = ((h ^ (h >> 16)) * 0x85EBCA6B) & 0xFFFFFFFF
+    h = ((h ^ (h >> 13)) * 0xC2B2AE35) & 0xFFFFFFFF
+    return h ^ (h >> 16)
+
+
+def build_perfect_hash(entries):
+    """
+    Hash-and-displace: bucket the names by hash(0), then, largest bucket
+    first, search for a seed that sends every name of the bucket to a free
+    slot. Single-name buckets are placed directly and store -(slot + 1).
+    Returns (slots, seeds), both len(entries) long.
+    """
+    n = len(entries)
+    if not n:
+        return [], []
+    buckets = [[] for _ in range(n)]
+    for entry in entries:
+        buckets[migration_hash(0, entry.old) % n].append(entry)
+
+    slots = [None] * n
+    seeds = [0] * n
+    order = sorted(range(n), key=lambda b: len(buckets[b]), reverse=True)
+    for b in order:
+        bucket = buckets[b]
+        if len(bucket) <= 1:
+            break
+        for seed in range(1, MAX_SEED):
+            placed = {migration_hash(seed, e.old) % n for e in bucket}
+            if (len(placed) == len(bucket) and
+                    all(slots[p] is None for p in placed)):
+                break
+        else:
+            sys.exit("error: no perfect hash seed found")
+        seeds[b] = seed
+        for entry in bucket:
+            slots[migration_hash(seed, entry.old) % n] = entry
+
+    free = [i for i in range(n) if slots[i] is None]
+    for b in order:
+        if len(buckets[b]) != 1:
+            continue
+        slot = free.pop()
+        slots[slot] = buckets[b][0]
+        seeds[b] = -slot - 1
+    return slots, seeds
+
+
+# ---------------------------------------------------------------------------
+# Output
+# ---------------------------------------------------------------------------
+
+def c_string(text):
+    return '"' + text.replace("\\", "\\\\").replace('"', '\\"') + '"'
+
+
+def emit_array(lines, ctype, name, items):
+    """
+    Emit a constexpr array of the given initializer lines; an empty one is an
+    empty ArrayRef, since C++ has no zero-length arrays.
+    """
+    if not items:
+        lines.append(f"static constexpr ArrayRef<{ctype}> {name}{{}};")
+        return
+    lines.append(f"static constexpr {ctype} {name}[] = {{")
+    lines += items
+    lines.append("};")
+
+
+def emit_seeds(lines, prefix, seeds):
+    if not seeds:
+        emit_array(lines, "int32_t", f"{prefix}Seeds", [])
+        return
+    lines.append(f"static constexpr int32_t {prefix}Seeds[] = {{")
+    row = "   "
+    for seed in seeds:
+        item = f" {seed},"
+        if len(row) + len(item) > 80:
+            lines.append(row)
+            row = "   "
+        row += item
+    lines.append(row)
+    lines.append("};")
+
+
+def emit_registry(entries, prefix, registry):
+    """Emit <prefix>Slots, <prefix>Seeds and the registry built on them."""
+    slots, seeds = build_perfect_hash(entries)
+    lines = [f"// {len(entries)} entries"]
+    emit_array(lines, "MigrationEntry", f"{prefix}Slots", [
+        f"    {{MigrationCheck::{e.check}, MigrationKind::{e.kind}, "
+        f"{c_string(e.header)}, {c_string(e.old)}, {c_string(e.new)}, "
+        f"{c_string(e.note)}}},"
+        for e in slots])
+    emit_seeds(lines, prefix, seeds)
+    lines.append(f"static constexpr MigrationRegistry "
+                 f"{registry}({prefix}Slots, {prefix}Seeds);")
+    return lines
+
+
+def emit_rewrites(entries):
+    """Flat argument / piece / template tables plus SDLCallRewrites."""
+    groups = {}
+    for e in entries:
+        groups.setdefault(e.old, []).append(e)
+    args, pieces, rewrites, sets = [], [], [], []
+    for name, group in groups.items():
+        first = len(rewrites)
+        for e in group:
+            rewrites.append(f"    {{{len(args)}, {len(e.args)}, "
+                            f"{len(pieces)}, {len(e.pieces)}, "
+                            f"{c_string(e.note)}}},")
+            args += e.args
+            pieces += e.pieces
+        head = Entry(group[0].check, None, group[0].header, name, "", "")
+        head.first, head.count = first, len(group)
+        sets.append(head)
+
+    slots, seeds = build_perfect_hash(sets)
+    lines = [f"// {len(rewrites)} call rewrites of {len(sets)} functions"]
+    emit_array(lines, "RewriteArg", "SDLRewriteArgs", [
+        "    {true, 0u}," if arg is None else f"    {{false, {arg}u}},"
+        for arg in args])
+    emit_array(lines, "RewritePiece", "SDLRewritePieces", [
+        f"    {{{c_string(text)}, {arg}}}," for text, arg in pieces])
+    emit_array(lines, "CallRewrite", "SDLCallRewriteList", rewrites)
+    emit_array(lines, "CallRewriteSet", "SDLCallRewriteSlots", [
+        f"    {{MigrationCheck::{s.check}, {c_string(s.header)}, "
+        f"{c_string(s.old)}, {s.first}, {s.count}}},"
+        for s in slots])
+    emit_seeds(lines, "SDLCallRewrite", seeds)
+    lines.append("static constexpr CallRewriteTable "
+                 "SDLCallRewrites(SDLCallRewriteSlots, SDLCallRewriteSeeds);")
+    return lines
+
+
+def emit_header_checks(rows):
+    """SDLHeaderChecks: header -> mask of the checks owning its rows."""
+    checks = {}
+    for e in rows:
+        owners = checks.setdefault(e.header, [])
+        if e.check not in owners:
+            owners.append(e.check)
+    heads = [Entry(None, None, None, header, "", "") for header in checks]
+    slots, seeds = build_perfect_hash(heads)
+    lines = [f"// {len(heads)} headers"]
+    emit_array(lines, "HeaderChecks", "SDLHeaderCheckSlots", [
+        f"    {{{c_string(h.old)}, "
+        + " | ".join(f"MaskOf(MigrationCheck::{c})" for c in checks[h.old])
+        + "},"
+        for h in slots])
+    emit_seeds(lines, "SDLHeaderCheck", seeds)
+    lines.append("static constexpr HeaderChecksTable "
+                 "SDLHeaderChecks(SDLHeaderCheckSlots, SDLHeaderCheckSeeds);")
+    return lines
+
+
+def main():
+    if len(sys.argv) != 3:
+        sys.exit(__doc__.strip().splitlines()[-1])
+    source, output = sys.argv[1], sys.argv[2]
+    sections = parse(source)
+
+    lines = [
+        f"// Generated by tools/gen_migration_tables.py from "
+        f"{os.path.basename(source)}.",
+        "// Do not edit; change the data file and rebuild.",
+        "",
+    ]
+    rows = [e for _, entries in sections for e in entries]
+    lines += emit_registry([e for e in rows
+                            if e.kind not in ("BoolReturn", "CallRewrite")],
+                           "SDLMigration", "SDLMigrations")
+    lines.append("")
+    lines += emit_registry([e for e in rows if e.kind == "BoolReturn"],
+                           "SDLBoolReturn", "SDLBoolReturns")
+    lines.append("")
+    lines += emit_rewrites([e for e in rows if e.kind == "CallRewrite"])
+    lines.append("")
+    lines += emit_header_checks(rows)
+    lines.append("")
+
+    text = "\n".join(lines)
+    # Leave the file and its mtime alone when nothing changed so the plugin
+    # is not rebuilt; the build tracks the generator run by a stamp file
+    if os.path.exists(output):
+        with open(output) as f:
+            if f.read() == text:
+                return
+    with open(output, "w") as f:
+        f.write(text)
+
+
+if __name__ == "__main__":
+    main()